@@ -0,0 +1,85 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include <mare/internal/debug.hh>
+#include <mare/logging.hh>
+#include <mare/mare.h>
+
+///////////////
+//
+//  Goal is to
+//  measure what runtime-switchable logging costs on the launch of
+//  small tasks: with logging stopped, which is the default, with
+//  logging started but no logger selected, and with the event counter
+//  logger and the trace logger selected.
+//
+//  Build this example with -DMARE_NO_RUNTIME_LOGGING to compare with
+//  a build where the loggers are compiled out; with logging stopped,
+//  the two should be within noise of each other.
+
+const std::size_t num_tasks = 100000;
+const std::size_t num_repetitions = 5;
+
+// Returns the best time per task, in nanoseconds, of launching
+// num_tasks empty tasks into a group and waiting for them.
+static double
+measure_launch()
+{
+  double best = 0;
+  for (std::size_t r = 0; r < num_repetitions; r++) {
+    auto g = mare::create_group();
+    auto start = std::chrono::system_clock::now();
+    for (std::size_t i = 0; i < num_tasks; i++)
+      mare::launch(g, [] { });
+    mare::wait_for(g);
+    auto end = std::chrono::system_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() /
+      num_tasks;
+    best = (r == 0) ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+int main() {
+  mare::runtime::init();
+
+  // Warm up the thread pool and the task allocator
+  measure_launch();
+
+  MARE_LLOG("%-32s %8.1f ns/task", "logging stopped", measure_launch());
+
+  mare::logging::set_loggers("none");
+  mare::logging::start();
+  MARE_LLOG("%-32s %8.1f ns/task", "started, no logger selected",
+            measure_launch());
+
+  mare::logging::set_loggers("event_counter");
+  MARE_LLOG("%-32s %8.1f ns/task", "started, event_counter",
+            measure_launch());
+
+  mare::logging::set_loggers("trace");
+  MARE_LLOG("%-32s %8.1f ns/task", "started, trace",
+            measure_launch());
+  mare::logging::stop();
+
+  mare::runtime::shutdown();
+  return 0;
+}
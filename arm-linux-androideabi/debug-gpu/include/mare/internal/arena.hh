@@ -0,0 +1,139 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+#include <mare/internal/nodecache.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Chunk of memory from which an arena bumps its allocations.
+///
+/// The header is followed by _capacity bytes of memory, the first _top
+/// of which have been handed out. Standard chunks have a fixed size and
+/// are recycled through arena_chunk_cache; allocations that are too large
+/// for them get a chunk of their own, which goes back to malloc.
+class arena_chunk {
+public:
+  static const std::size_t standard_size = 32 * 1024;
+
+  static constexpr std::size_t header_size()
+  {
+    return (sizeof(arena_chunk) + alignof(std::max_align_t) - 1) &
+      ~(alignof(std::max_align_t) - 1);
+  }
+
+  static constexpr std::size_t standard_capacity()
+  {
+    return standard_size - header_size();
+  }
+
+  arena_chunk(std::size_t capacity, bool standard) :
+    _next(nullptr),
+    _capacity(capacity),
+    _top(0),
+    _standard(standard) {
+  }
+
+  MARE_DELETE_METHOD(arena_chunk(arena_chunk const&));
+  MARE_DELETE_METHOD(arena_chunk& operator=(arena_chunk const&));
+
+  /// Carves size bytes aligned to align off the chunk. Returns nullptr
+  /// if they do not fit. May be called concurrently.
+  void* try_allocate(std::size_t size, std::size_t align)
+  {
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(data());
+    std::size_t top = _top.load(std::memory_order_relaxed);
+    do {
+      std::uintptr_t p = (base + top + align - 1) &
+        ~static_cast<std::uintptr_t>(align - 1);
+      std::size_t end = static_cast<std::size_t>(p - base) + size;
+      if (end > _capacity)
+        return nullptr;
+      if (_top.compare_exchange_weak(top, end, std::memory_order_relaxed))
+        return reinterpret_cast<void*>(p);
+    } while (true);
+  }
+
+  bool is_standard() const { return _standard; }
+
+  /// Links the chunks of an arena; only touched under the arena's lock
+  arena_chunk* _next;
+
+private:
+  char* data() { return reinterpret_cast<char*>(this) + header_size(); }
+
+  std::size_t const _capacity;
+  std::atomic<std::size_t> _top;
+  bool const _standard;
+};
+
+/// Source of arena chunks.
+///
+/// Standard chunks are kept in a node_cache, so that a worker that
+/// refills arenas reuses the chunks that it or other workers released,
+/// mostly without taking a lock. Batches are kept small because chunks
+/// are large: a thread holds at most 2 * 16 chunks (1 MiB), and the
+/// stash at most 16 batches (8 MiB).
+class arena_chunk_cache {
+public:
+  static arena_chunk* acquire()
+  {
+    void* mem = cache::allocate(sizeof(block));
+    return new (mem) arena_chunk(arena_chunk::standard_capacity(), true);
+  }
+
+  static arena_chunk* acquire_large(std::size_t capacity)
+  {
+    if (capacity > std::numeric_limits<std::size_t>::max() -
+                   arena_chunk::header_size())
+      throw std::bad_alloc();
+    void* mem = malloc(arena_chunk::header_size() + capacity);
+    if (mem == nullptr)
+      throw std::bad_alloc();
+    return new (mem) arena_chunk(capacity, false);
+  }
+
+  static void release(arena_chunk* c)
+  {
+    bool standard = c->is_standard();
+    c->~arena_chunk();
+    if (standard)
+      cache::deallocate(c);
+    else
+      free(c);
+  }
+
+private:
+  struct block {
+    alignas(std::max_align_t) char _bytes[arena_chunk::standard_size];
+  };
+
+  typedef node_cache<block, 16, 16> cache;
+};
+
+} //namespace internal
+
+} //namespace mare
@@ -18,6 +18,7 @@
 #include <mare/internal/alignedatomic.hh>
 #include <mare/internal/hazardpointers.hh>
 #include <mare/internal/debug.hh>
+#include <mare/internal/nodecache.hh>
 #include <iostream>
 #include <sstream>
 #include <mutex>
@@ -36,6 +37,11 @@
 #define MARE_DQ_DEBUG
 #endif
 
+// Allocates qnodes from a node_cache instead of malloc. Off by default:
+// it only pays off for shallow queues, and it lowers the throughput of
+// concurrent producers and consumers (see examples/dualtaskqueue.cc).
+//#define MARE_DQ_NODE_CACHE
+
 #define MARE_CPTR_DELETEME_PTR (reinterpret_cast<qnode*>(0x1))
 #define MARE_CPTR_CLAIMDELETION_PTR (reinterpret_cast<qnode*>(0x2))
 
@@ -53,6 +59,10 @@ namespace internal
 ///   - CAS-1-2 marking of nodes for freeing. A dequeue is allowed to bailout
 ///     prematurely, however at this leaves a node in the chain. We mark this
 ///     node as safe to delete and let the visiting enqueuer delete it.
+///   - With MARE_DQ_NODE_CACHE, qnodes are allocated from a node_cache,
+///     which recycles the nodes deleted by the hazard pointer manager
+///     through per-thread free lists. Allocation statistics are only kept
+///     with MARE_DQ_DEBUG_MEMORY.
 ///
 /// IMPORTANT NOTE:
 ///   - When using a lock-based alignedatomic<T>, the unsafe delete is in fact
@@ -364,11 +374,9 @@ public:
   template <typename PREDICATE>
   bool popIf(PREDICATE pred, T& element, paired_mutex_cv* synch) {
 
-    // Setup new qnode
-    qnode* node = new qnode();
-    MARE_INTERNAL_ASSERT(node, "node init failure");
-
-    node->_next.storeNA(ctptr(nullptr, true));
+    // The request qnode is only allocated once the queue is found empty,
+    // so that dequeuers that find data do not allocate at all.
+    qnode* node = nullptr;
 
 #ifndef NDEBUG
     typename hp::Manager<qnode,2>::CheckCleanOnDestroy checkClean(_HPManager);
@@ -439,6 +447,11 @@ public:
           if (next.ptr() != nullptr) {     // tail falling behind
             (void) cas(tail(), myTail, ctptr(next.ptr(), next.isRequest()));
           } else {    // try to link in a request for data
+            if (node == nullptr) {
+              node = new qnode();
+              MARE_INTERNAL_ASSERT(node, "node init failure");
+              node->_next.storeNA(ctptr(nullptr, true));
+            }
             if (cas(myTail.ptr()->_next, next, ctptr(node, true))) {
 
               myTail.ptr()->init_synch(synch);
@@ -691,8 +704,8 @@ public:
 #endif
             _HPManager.retireNode(myHead.ptr());
 
-            // Delete uselessly allocated node
-            // FIXME: optimization: never alloc node
+            // Delete the request node, if we allocated one in an earlier
+            // iteration
             delete node;
 
 #ifdef MARE_DQ_DEBUG_ELEMENTS
@@ -1087,6 +1100,14 @@ public:
     }
     void operator delete (void* ptr, void* voidptr2) throw() {
     }
+#elif defined(MARE_DQ_NODE_CACHE) && !defined(MARE_QUEUE_FORCE_MALLOC)
+    void* operator new(std::size_t size) {
+      return node_cache<qnode>::allocate(size);
+    }
+
+    void operator delete(void* ptr) {
+      node_cache<qnode>::deallocate(ptr);
+    }
 #endif
 
 //    void print() {
@@ -0,0 +1,302 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/tlsptr.hh>
+
+namespace mare {
+
+namespace internal {
+
+namespace ebr {
+
+///
+/// Epoch-based reclamation, as described in
+///
+///   K. Fraser. Practical lock-freedom. PhD thesis, University of
+///   Cambridge, 2004.
+///
+/// Readers do not announce the nodes they use, as with hp::Manager, but
+/// only that they are inside a critical section. enter() publishes the
+/// global epoch the thread observed; exit() leaves the critical section.
+/// A node retired in epoch e is deleted once the global epoch has reached
+/// e + 2: the epoch only advances once every thread inside a critical
+/// section has observed the current epoch, so by then no thread can still
+/// be in a critical section that started before the node was unlinked.
+///
+/// Compared to hp::Manager, a read costs one store and one fence per
+/// critical section instead of per node, and a scan is a walk over the
+/// records of the threads rather than a search of every retired node in
+/// all hazard pointers. On the other hand, a thread that stays inside a
+/// critical section delays the reclamation of all retired nodes.
+///
+
+///
+/// Per-thread state. Only the thread that claimed a record accesses
+/// _nesting and _retired; _state is read by all threads.
+///
+template<typename TN>
+struct Record {
+  Record() :
+    _state(0),
+    _claimed(false),
+    _next(nullptr),
+    _nesting(0),
+    _retired() {
+  }
+
+  MARE_DELETE_METHOD(Record(Record const&));
+  MARE_DELETE_METHOD(Record& operator=(Record const&));
+
+  // Override operator new and delete if macro defined in memdebug.hh
+  MARE_OPERATOR_NEW_OVERRIDE
+
+  bool tryClaim() {
+    bool expected = false;
+    return !_claimed.load() && _claimed.compare_exchange_strong(expected,
+                                                                true);
+  }
+
+  void release() {
+    _claimed.store(false);
+  }
+
+  /// Deletes the retired nodes of epochs before min_epoch.
+  void reclaim(size_t min_epoch) {
+    size_t kept = 0;
+    for(size_t i = 0; i < _retired.size(); ++i) {
+      if(_retired[i].second < min_epoch) {
+        delete _retired[i].first;
+      } else {
+        _retired[kept++] = _retired[i];
+      }
+    }
+    _retired.resize(kept);
+  }
+
+  // (epoch << 1) | 1 while in a critical section, 0 otherwise
+  std::atomic<size_t> _state;
+  std::atomic<bool> _claimed;
+  Record* _next;
+
+  size_t _nesting;
+  std::vector<std::pair<TN*, size_t> > _retired;
+};
+
+///
+/// Holds the record of a thread in the TLS of an ebr::Manager. When the
+/// thread exits without having called threadFinish(), the record is
+/// released, so that a thread started later can claim it, together with
+/// the nodes it still has to reclaim.
+///
+template<typename R>
+struct record_box {
+  R* _ptr;
+  record_box(R* ptr) : _ptr(ptr) {}
+  MARE_DELETE_METHOD(record_box(record_box const&));
+  MARE_DELETE_METHOD(record_box& operator=(record_box const&));
+  ~record_box() {
+    if(_ptr) {
+      _ptr->release();
+    }
+  }
+  R* get() const {
+    return _ptr;
+  }
+  record_box& operator=(R* const& ptr) {
+    _ptr = ptr;
+    return *this;
+  }
+};
+
+///
+/// The ebr::Manager manages epochs of one data structure. Its interface
+/// follows hp::Manager: call threadInit() or threadInitAuto() in each
+/// thread before using it and threadFinish() when done, and retireNode()
+/// to hand over a node that has been unlinked. A thread that exits
+/// without calling threadFinish() releases its record automatically. Readers bracket their
+/// accesses with enter() and exit() instead of using hazard pointer
+/// slots.
+///
+template<typename TN>
+class Manager {
+public:
+  typedef Record<TN>* Record_p;
+  static const size_t RETIRE_THRESHOLD = 64;
+
+  Manager() :
+    _epoch(0),
+    _headRecord(nullptr),
+    _myrec() {
+  }
+
+  ///
+  /// Deletes all retired nodes and all records.
+  /// NOTE: no thread may use the manager anymore.
+  ///
+  ~Manager() {
+    reclaimAll();
+    Record_p rec = _headRecord;
+    while(rec) {
+      Record_p next = rec->_next;
+      delete rec;
+      rec = next;
+    }
+  }
+
+  MARE_DELETE_METHOD(Manager(Manager const&));
+  MARE_DELETE_METHOD(Manager& operator=(Manager const&));
+
+  void threadInit() {
+    MARE_INTERNAL_ASSERT(
+      !_myrec,
+      "Please call threadInit() only on an uninitialized thread");
+    allocRecord();
+  }
+
+  void threadInitAuto() {
+    if(!_myrec) {
+      allocRecord();
+    }
+  }
+
+  void threadFinish() {
+    MARE_INTERNAL_ASSERT(
+      _myrec,
+      "Please call threadInit() on each thread using ebr::Manager");
+    MARE_INTERNAL_ASSERT(_myrec->_nesting == 0,
+                         "threadFinish() inside a critical section");
+    _myrec->release();
+    _myrec = nullptr;
+  }
+
+  void threadFinishAuto() {
+    if(_myrec) {
+      threadFinish();
+    }
+  }
+
+  ///
+  /// Enters a critical section. Nodes reachable from within the critical
+  /// section are not deleted before the matching exit(). Critical
+  /// sections may be nested.
+  ///
+  void enter() {
+    Record_p rec = _myrec;
+    if(rec->_nesting++ == 0) {
+      rec->_state.store((_epoch.load() << 1) | 1);
+      // Publish _state before the loads of the critical section
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  void exit() {
+    Record_p rec = _myrec;
+    MARE_INTERNAL_ASSERT(rec->_nesting > 0, "exit() without enter()");
+    if(--rec->_nesting == 0) {
+      rec->_state.store(0, std::memory_order_release);
+    }
+  }
+
+  ///
+  /// Signal that the specified node is to be deleted as soon as no thread
+  /// can be using it anymore.
+  /// Note that threadInit() has to be called for the calling thread.
+  /// IMPORTANT: You have to make sure the specified node cannot be
+  /// reached anymore by threads entering a critical section after this
+  /// call.
+  /// @param node Node to be deleted.
+  ///
+  void retireNode(TN* node) {
+    Record_p rec = _myrec;
+    MARE_INTERNAL_ASSERT(
+      rec,
+      "Please call threadInit() on each thread using ebr::Manager");
+    rec->_retired.push_back(std::make_pair(node, _epoch.load()));
+    if(rec->_retired.size() >= RETIRE_THRESHOLD) {
+      tryAdvance();
+      size_t epoch = _epoch.load();
+      if(epoch >= 2) {
+        rec->reclaim(epoch - 1);
+      }
+    }
+  }
+
+  ///
+  /// Deletes the retired nodes of all records, regardless of epochs.
+  /// IMPORTANT: Only call this once no thread uses the datastructure
+  /// anymore.
+  ///
+  void reclaimAll() {
+    for(Record_p rec = _headRecord; rec; rec = rec->_next) {
+      for(auto& retired : rec->_retired) {
+        delete retired.first;
+      }
+      rec->_retired.clear();
+    }
+  }
+
+private:
+  ///
+  /// Advances the global epoch if all threads inside a critical section
+  /// have observed it.
+  ///
+  void tryAdvance() {
+    size_t epoch = _epoch.load();
+    for(Record_p rec = _headRecord; rec; rec = rec->_next) {
+      size_t state = rec->_state.load();
+      if((state & 1) && (state >> 1) != epoch) {
+        return;
+      }
+    }
+    _epoch.compare_exchange_strong(epoch, epoch + 1);
+  }
+
+  void allocRecord() {
+    // Try to reuse a record of a finished thread
+    for(Record_p rec = _headRecord; rec; rec = rec->_next) {
+      if(rec->tryClaim()) {
+        _myrec = rec;
+        return;
+      }
+    }
+
+    Record_p rec = new Record<TN>();
+    rec->tryClaim();
+    Record_p oldHead = _headRecord;
+    do {
+      rec->_next = oldHead;
+    } while(!_headRecord.compare_exchange_weak(oldHead, rec));
+    _myrec = rec;
+  }
+
+  std::atomic<size_t> _epoch;
+  std::atomic<Record_p> _headRecord;
+  tlsptr<Record<TN>, record_box> _myrec;
+};
+
+template<typename TN>
+const size_t Manager<TN>::RETIRE_THRESHOLD;
+
+} //namespace ebr
+
+} //namespace internal
+
+} //namespace mare
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstring>
 #include <thread>
 
 #include <mare/internal/compat.h>
@@ -25,11 +26,56 @@ namespace internal {
 
 class task;
 class group;
+class sdf_node_common;
 
 namespace log {
 
 typedef unsigned int event_id;
 
+/**
+   Events are grouped in classes, which can be enabled and disabled
+   at runtime. See infrastructure::set_event_classes().
+*/
+typedef unsigned int event_class_set;
+
+namespace event_class {
+
+enum : event_class_set {
+  none     = 0,
+  group    = 1 << 0,
+  task     = 1 << 1,
+  refcount = 1 << 2,
+  sdf      = 1 << 3,
+  pfor     = 1 << 4,
+  runtime  = 1 << 5,
+  all      = (1 << 6) - 1
+};
+
+} // mare::internal::log::event_class
+
+/**
+   Returns the event class whose name is the first len characters of
+   name, or event_class::none if there is none.
+*/
+inline event_class_set find_event_class(const char* name, size_t len) {
+  static const struct {
+    const char* _name;
+    event_class_set _class;
+  } s_classes[] = {
+    { "group", event_class::group },
+    { "task", event_class::task },
+    { "refcount", event_class::refcount },
+    { "sdf", event_class::sdf },
+    { "pfor", event_class::pfor },
+    { "runtime", event_class::runtime }
+  };
+  for (auto const& c : s_classes) {
+    if (strlen(c._name) == len && strncmp(c._name, name, len) == 0)
+      return c._class;
+  }
+  return event_class::none;
+}
+
 
 /**
    Some operations are expensive. For example, geting the tie
@@ -118,6 +164,9 @@ struct base_event {
   static constexpr event_id ID = EVENT_ID;
   static constexpr event_id get_id() { return EVENT_ID; }
 
+  // Events that belong to no class are never logged
+  static constexpr event_class_set get_class() { return event_class::none; }
+
 };
 
 /**
@@ -182,6 +231,21 @@ struct single_task_event : public single_object_event<EVENT_ID, task> {
 
 };
 
+/** Base class for events that involve just one SDF node. */
+template <event_id EVENT_ID>
+struct single_sdf_node_event :
+    public single_object_event<EVENT_ID, sdf_node_common> {
+
+  single_sdf_node_event(sdf_node_common* n) :
+    single_object_event<EVENT_ID, sdf_node_common>(n) { }
+
+  // Returns node that caused the event
+  sdf_node_common* get_node() const {
+    return single_object_event<EVENT_ID, sdf_node_common>::get_object();
+  }
+
+};
+
 /** Base class for class_reffed, class_unreffed events.*/
 template <event_id EVENT_ID>
 struct task_ref_count_event : public single_task_event<EVENT_ID> {
@@ -0,0 +1,316 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file io.hh */
+#pragma once
+
+#include <cerrno>
+#include <memory>
+#include <type_traits>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/reactor.hh>
+#include <mare/internal/runtime.hh>
+
+namespace mare
+{
+
+namespace internal
+{
+
+template<typename Body>
+task_ptr launch_on(group_ptr const& group, int fd, reactor::event ev,
+                   Body&& body)
+{
+  auto t = create_task(std::forward<Body>(body));
+  if (group != nullptr)
+    join_group(group, t);
+  bool armed;
+  try {
+    armed = reactor::instance().arm(fd, ev, [t] {
+        if (runtime_available())
+          launch(t);
+      });
+  } catch (...) {
+    // Do not leave a task that never runs in group.
+    cancel(t);
+    launch(t);
+    throw;
+  }
+  // Regular files are always ready.
+  if (!armed)
+    launch(t);
+  return t;
+}
+
+/// Reads from fd on the reactor thread once fd is readable, and passes
+/// the result of read() to complete. Returns false, without arming
+/// anything, if fd cannot be polled.
+///
+/// All the read waiters of fd are run by the same readiness event, and
+/// the first ones can drain fd. So fd is polled again right before the
+/// read, and the read is rearmed instead of blocking the reactor thread
+/// if there is nothing left to read.
+template<typename Complete>
+bool read_when_readable(task_ptr const& t, int fd, void* buf, size_t count,
+                        Complete const& complete)
+{
+  return reactor::instance().arm(fd, reactor::readable,
+    [t, fd, buf, count, complete] {
+      if (canceled(t))
+        return complete(0);
+      pollfd p;
+      p.fd = fd;
+      p.events = POLLIN;
+      p.revents = 0;
+      int ready;
+      while ((ready = poll(&p, 1, 0)) < 0 && errno == EINTR) { }
+      if (ready != 0)
+        return complete(read(fd, buf, count));
+      try {
+        if (!read_when_readable(t, fd, buf, count, complete))
+          complete(read(fd, buf, count));
+      } catch (api_exception&) {
+        errno = EBADF;
+        complete(-1);
+      }
+    });
+}
+
+template<typename Body>
+task_ptr read_async(group_ptr const& group, int fd, void* buf, size_t count,
+                    off_t offset, Body&& body)
+{
+  typedef typename std::decay<Body>::type body_type;
+  auto result = std::make_shared<ssize_t>(0);
+  body_type b(std::forward<Body>(body));
+  auto t = create_task([result, b] {
+      b(*result);
+    });
+  if (group != nullptr)
+    join_group(group, t);
+
+  // Runs on the reactor thread.
+  auto complete = [t, result] (ssize_t n) {
+    *result = n < 0 ? -errno : n;
+    if (runtime_available())
+      launch(t);
+  };
+  bool armed;
+  try {
+    armed = read_when_readable(t, fd, buf, count, complete);
+  } catch (...) {
+    // Do not leave a task that never runs in group.
+    cancel(t);
+    launch(t);
+    throw;
+  }
+  if (!armed)
+    reactor::instance().post([t, fd, buf, count, offset, complete] {
+        complete(canceled(t) ? 0 : pread(fd, buf, count, offset));
+      });
+  return t;
+}
+
+} //namespace internal
+
+/** @addtogroup execution
+@{ */
+/**
+    Creates a new task and launches it into a group once a file
+    descriptor is ready for reading.
+
+    The task is created and added to <tt>group</tt> right away, and
+    launched as soon as a read from <tt>fd</tt> would not block, or
+    <tt>fd</tt> reports an error or a hangup. The descriptor is watched
+    by a reactor thread that MARE starts on first use, so no worker
+    thread blocks while the task waits. Regular files are always ready,
+    so the task is launched immediately.
+
+    Since the task belongs to <tt>group</tt> from the start,
+    <tt>mare::wait_for(group)</tt> also waits for tasks whose descriptor
+    is not ready yet, and <tt>mare::cancel(group)</tt> cancels them.
+
+    The task is launched once per call. Call
+    mare::launch_on_readable again from the task body to keep reading.
+    Do not close <tt>fd</tt> while tasks are waiting on it; cancel their
+    group first, or let them run.
+
+    @param group Pointer to group.
+    @param fd    File descriptor.
+    @param body  Task body.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If group points to null or fd cannot be
+    polled.
+
+    @par Example
+    @includelineno examples/reactor.cc
+
+    @sa mare::launch_on_writable(group_ptr const&, int, Body&&)
+    @sa mare::read_async(group_ptr const&, int, void*, size_t, off_t,
+                         Body&&)
+*/
+template<typename Body>
+task_ptr launch_on_readable(group_ptr const& group, int fd, Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+  return internal::launch_on(group, fd, internal::reactor::readable,
+                             std::forward<Body>(body));
+}
+
+/**
+    Creates a new task and launches it once a file descriptor is ready
+    for reading.
+
+    See mare::launch_on_readable(group_ptr const&, int, Body&&). Cancel
+    the returned task to drop it before <tt>fd</tt> is ready.
+
+    @param fd   File descriptor.
+    @param body Task body.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If fd cannot be polled.
+*/
+template<typename Body>
+task_ptr launch_on_readable(int fd, Body&& body)
+{
+  return internal::launch_on(nullptr, fd, internal::reactor::readable,
+                             std::forward<Body>(body));
+}
+
+/**
+    Creates a new task and launches it into a group once a file
+    descriptor is ready for writing.
+
+    See mare::launch_on_readable(group_ptr const&, int, Body&&).
+
+    @param group Pointer to group.
+    @param fd    File descriptor.
+    @param body  Task body.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If group points to null or fd cannot be
+    polled.
+*/
+template<typename Body>
+task_ptr launch_on_writable(group_ptr const& group, int fd, Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+  return internal::launch_on(group, fd, internal::reactor::writable,
+                             std::forward<Body>(body));
+}
+
+/**
+    Creates a new task and launches it once a file descriptor is ready
+    for writing.
+
+    See mare::launch_on_readable(group_ptr const&, int, Body&&).
+
+    @param fd   File descriptor.
+    @param body Task body.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If fd cannot be polled.
+*/
+template<typename Body>
+task_ptr launch_on_writable(int fd, Body&& body)
+{
+  return internal::launch_on(nullptr, fd, internal::reactor::writable,
+                             std::forward<Body>(body));
+}
+
+/**
+    Reads from a file descriptor without blocking a worker thread, then
+    launches a task into a group with the result.
+
+    Reads up to <tt>count</tt> bytes into <tt>buf</tt>, and launches a
+    task that calls <tt>body(result)</tt>, where <tt>result</tt> is
+    the number of bytes read, 0 at end of file, or <tt>-errno</tt> if
+    the read failed.
+
+    For pipes, sockets and other descriptors that can be polled, the
+    read happens once <tt>fd</tt> is readable, and <tt>offset</tt> is
+    ignored. Regular files cannot be polled; they are read with
+    <tt>pread(fd, buf, count, offset)</tt> on the reactor thread, so
+    the file offset of <tt>fd</tt> is not changed.
+
+    The task belongs to <tt>group</tt> from the start, as with
+    mare::launch_on_readable. If the group is canceled before the read
+    happens, nothing is read and <tt>body</tt> is not called.
+    <tt>buf</tt> must stay valid until the task has completed or has
+    been canceled.
+
+    @param group  Pointer to group.
+    @param fd     File descriptor.
+    @param buf    Destination buffer.
+    @param count  Maximum number of bytes to read.
+    @param offset Position in the file, for regular files.
+    @param body   Task body. Takes a <tt>ssize_t</tt>.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If group points to null or fd is not a valid
+    descriptor.
+
+    @par Example
+    @includelineno examples/reactor.cc
+*/
+template<typename Body>
+task_ptr read_async(group_ptr const& group, int fd, void* buf, size_t count,
+                    off_t offset, Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+  return internal::read_async(group, fd, buf, count, offset,
+                              std::forward<Body>(body));
+}
+
+/**
+    Reads from a file descriptor without blocking a worker thread, then
+    launches a task with the result.
+
+    See mare::read_async(group_ptr const&, int, void*, size_t, off_t,
+                         Body&&). Cancel the returned task to drop the
+    read.
+
+    @param fd     File descriptor.
+    @param buf    Destination buffer.
+    @param count  Maximum number of bytes to read.
+    @param offset Position in the file, for regular files.
+    @param body   Task body. Takes a <tt>ssize_t</tt>.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If fd is not a valid descriptor.
+*/
+template<typename Body>
+task_ptr read_async(int fd, void* buf, size_t count, off_t offset,
+                    Body&& body)
+{
+  return internal::read_async(nullptr, fd, buf, count, offset,
+                              std::forward<Body>(body));
+}
+/** @} */ /* end_addtogroup execution */
+
+} //namespace mare
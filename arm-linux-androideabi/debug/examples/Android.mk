@@ -43,24 +43,47 @@ endef
 example_names :=             \
 	abort-on-cancel      \
 	after                \
+	arena                \
 	attrblocking         \
 	attrlongrunning      \
+	barrier              \
 	cancel-group         \
+	cofunbounded         \
+	concurrenthashmap    \
+	coroutines           \
 	dom-styling1         \
 	dom-styling2         \
+	dualtaskqueue        \
+	fiberwait            \
 	helloworld1          \
+	injectionqueue       \
+	loggingoverhead      \
 	mm                   \
+	mpmcqueue            \
+	mutexcontention      \
+	pageallocator        \
+	reactor              \
 	sdfadvanced          \
 	sdfadvanceddebug     \
 	sdfassigncost        \
 	sdfasynclaunch       \
 	sdfbasicpipe         \
+	sdfbatch             \
 	sdfbodytypes         \
 	sdffilter            \
 	sdffiltergeneralized \
+	sdffusion            \
 	sdfpauseresumecancel \
+	sdfprofile           \
 	sdfprogrammatic      \
-	storage1
+	sdfreplacebody       \
+	sdfreplicate         \
+	sharedmutex          \
+	storage1             \
+	storagelookup        \
+	timedwait            \
+	timers               \
+	tracing
 
 ifeq ($(MARE_HAVE_GPU),1)
   example_names += vector-add-gpu vector-add-gpu-pfor-each
@@ -0,0 +1,192 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/condition_variable.hh>
+#include <mare/mpmcqueue.hh>
+#include <mare/mutex.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::mpmc_queue to pass elements from
+//     producer tasks to consumer tasks through a bounded queue, and
+//  2. compare how the throughput scales with the number of producers and
+//     consumers against a std::queue protected by a mare::mutex, with and
+//     without the batch operations push_n()/pop_n().
+//
+//  Each benchmark launches num_producers producer tasks and as many
+//  consumer tasks. Producers push num_elements elements in total and
+//  consumers pop all of them; the blocking push() and pop() make tasks
+//  wait in MARE while the queue is full or empty.
+
+const std::size_t num_elements = 1 << 20;
+const std::size_t capacity     = 1024;
+const std::size_t batch_size   = 32;
+
+// The status quo: a std::queue bounded to capacity elements, protected
+// by a mare::mutex
+class locked_queue {
+public:
+  explicit locked_queue(std::size_t max_size) :
+    _capacity(max_size),
+    _mutex(),
+    _not_full(),
+    _not_empty(),
+    _queue() {}
+
+  void push(std::size_t v) {
+    std::unique_lock<mare::mutex> lock(_mutex);
+    _not_full.wait(lock, [this] { return _queue.size() < _capacity; });
+    _queue.push(v);
+    _not_empty.notify_one();
+  }
+
+  void pop(std::size_t& r) {
+    std::unique_lock<mare::mutex> lock(_mutex);
+    _not_empty.wait(lock, [this] { return !_queue.empty(); });
+    r = _queue.front();
+    _queue.pop();
+    _not_full.notify_one();
+  }
+
+private:
+  std::size_t const _capacity;
+  mare::mutex _mutex;
+  mare::condition_variable _not_full;
+  mare::condition_variable _not_empty;
+  std::queue<std::size_t> _queue;
+};
+
+struct single {
+  template<typename Queue>
+  static void produce(Queue& q, std::size_t first, std::size_t n) {
+    for (std::size_t i = first; i < first + n; i++)
+      q.push(i);
+  }
+
+  template<typename Queue>
+  static std::size_t consume(Queue& q, std::size_t n) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      std::size_t v;
+      q.pop(v);
+      sum += v;
+    }
+    return sum;
+  }
+};
+
+struct batched {
+  static void produce(mare::mpmc_queue<std::size_t>& q,
+                      std::size_t first, std::size_t n) {
+    std::vector<std::size_t> batch(batch_size);
+    for (std::size_t i = first; i < first + n; i += batch_size) {
+      for (std::size_t j = 0; j < batch_size; j++)
+        batch[j] = i + j;
+      q.push_n(batch.begin(), batch_size);
+    }
+  }
+
+  static std::size_t consume(mare::mpmc_queue<std::size_t>& q,
+                             std::size_t n) {
+    std::vector<std::size_t> batch(batch_size);
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < n; i += batch_size) {
+      q.pop_n(batch.begin(), batch_size);
+      for (auto v : batch)
+        sum += v;
+    }
+    return sum;
+  }
+};
+
+// Empty batches return right away, even on a full or empty queue
+void
+check_empty_batches()
+{
+  mare::mpmc_queue<std::size_t> q(4);
+  std::size_t values[4] = {0, 1, 2, 3};
+  if (q.try_push_n(values, 0) != 0 || q.try_pop_n(values, 0) != 0)
+    MARE_FATAL("empty batch moved elements");
+  q.pop_n(values, 0);
+  q.push_n(values, 4);
+  q.push_n(values, 0);
+  if (q.try_push_n(values, 0) != 0 || q.size() != 4)
+    MARE_FATAL("empty batch moved elements");
+}
+
+// Returns the throughput, in elements/s
+template<typename Queue, typename Mode>
+double
+run(std::size_t num_producers)
+{
+  static_assert(num_elements % (batch_size * 8) == 0,
+                "each task must move a whole number of batches");
+
+  Queue q(capacity);
+  std::size_t per_task = num_elements / num_producers;
+  std::atomic<std::size_t> sum(0);
+
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_producers; t++) {
+    mare::launch(g, [&q, &sum, per_task] {
+        sum += Mode::consume(q, per_task);
+      });
+    mare::launch(g, [&q, t, per_task] {
+        Mode::produce(q, t * per_task, per_task);
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  std::size_t n = num_elements;
+  assert(sum == n * (n - 1) / 2);
+  MARE_UNUSED(n);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_elements) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  check_empty_batches();
+
+  MARE_LLOG("producers/consumers   locked_queue    mpmc_queue   "
+            "mpmc_queue, batched   (elements/s)");
+  for (std::size_t p = 1; p <= 8; p *= 2) {
+    double locked  = run<locked_queue, single>(p);
+    double mpmc    = run<mare::mpmc_queue<std::size_t>, single>(p);
+    double mpmc_n  = run<mare::mpmc_queue<std::size_t>, batched>(p);
+    MARE_LLOG("%9zu %22.1f %13.1f %21.1f", p, locked, mpmc, mpmc_n);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
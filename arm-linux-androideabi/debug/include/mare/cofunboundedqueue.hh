@@ -0,0 +1,89 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file cofunboundedqueue.hh */
+#pragma once
+
+#include <mare/internal/cofunbounded.hh>
+
+namespace mare {
+
+/** @addtogroup cof_unbounded_queue
+@{ */
+/**
+   Unbounded FIFO queue for values of any type, built on top of the
+   same obstruction-free deque as cof_queue.
+
+   Unlike cof_queue, which stores values in the size_t slots of the
+   deque and is therefore limited to types no larger than a size_t,
+   values are moved into pooled nodes and only the addresses of the
+   nodes are stored in the deque; scalar values are stored in the deque
+   directly. T only needs to be move-constructible and move-assignable.
+
+   The storage is a list of deques. When the current deque is full,
+   another one twice its size is linked to the list instead of failing
+   the push. Memory is only returned to the system when the container
+   is destroyed.
+*/
+
+template<class T, class PREDICTOR = internal::cof::default_predictor>
+class cof_unbounded_queue {
+public:
+  typedef internal::cof::unbounded<T, PREDICTOR,
+                                   internal::cof::queue_segments<PREDICTOR> >
+          container_type;
+  typedef T value_type;
+
+  /** @param qsize Number of elements the queue can hold before it
+      needs to grow for the first time. */
+  explicit cof_unbounded_queue(size_t qsize = 1024) : _c(qsize) {}
+
+  MARE_DELETE_METHOD(cof_unbounded_queue(const cof_unbounded_queue&));
+  MARE_DELETE_METHOD(cof_unbounded_queue& operator=(const cof_unbounded_queue&));
+
+  /** Pushes a copy of v. @return Always true; the queue grows if needed.
+      @sa cof_deque::right_push */
+  bool push(const value_type& v) { _c.emplace(v); return true; }
+
+  /** Pushes v by moving it. @return Always true. */
+  bool push(value_type&& v) { _c.emplace(std::move(v)); return true; }
+
+  /** @sa cof_deque::left_pop */
+  bool pop(value_type& r) { return _c.pop(r); }
+
+  /** Pushes the n elements starting at first. Use std::make_move_iterator
+      to move move-only elements into the queue.
+
+      The overhead of locating the current deque is paid once per batch
+      of elements rather than once per element.
+
+      @return The number of elements pushed, which is always n.
+  */
+  template<class InputIt>
+  size_t try_push_n(InputIt first, size_t n) { return _c.push_n(first, n); }
+
+  /** Pops up to n elements, assigning them to result, result + 1, ...
+
+      @return The number of elements popped; less than n if the queue
+      was found empty.
+  */
+  template<class OutputIt>
+  size_t try_pop_n(OutputIt result, size_t n) { return _c.pop_n(result, n); }
+
+private:
+  container_type _c;
+};
+
+} // namespace mare
+/** @} */ /* end_addtogroup cof_unbounded_queue */
@@ -0,0 +1,107 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file concurrenthashmap.hh */
+#pragma once
+
+#include <functional>
+
+#include <mare/internal/concurrenthashmap.hh>
+#include <mare/reclamation.hh>
+
+namespace mare {
+
+/** @addtogroup concurrent_hash_map
+@{ */
+/**
+   Unordered map that can be used by many tasks concurrently.
+
+   Lookups take no lock. Inserts and erases lock one of a fixed number of
+   lock stripes, so writers only contend with writers of the same stripe.
+   Memory of erased or replaced elements is reclaimed once no lookup can
+   access it anymore, by the scheme selected with Reclamation: either
+   hazard_pointer_reclamation (the default) or epoch_based_reclamation.
+
+   When the map exceeds a load factor of one, it grows to twice its number
+   of buckets. The buckets are migrated a few at a time by subsequent
+   inserts and erases, so no single operation pays for the whole resize.
+
+   Elements are never modified in place: insert_or_assign() replaces an
+   element with a new one, and find() returns a copy of the value.
+
+   @note1 Key and T must be copy-constructible. Copies of T must be
+   safe to make while other tasks copy the same element.
+*/
+
+template<class Key,
+         class T,
+         class Hash = std::hash<Key>,
+         class KeyEqual = std::equal_to<Key>,
+         class Reclamation = hazard_pointer_reclamation>
+class concurrent_hash_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+
+  /** @param bucket_count Minimum initial number of buckets. */
+  explicit concurrent_hash_map(size_t bucket_count = 64) :
+    _m(bucket_count) {}
+
+  MARE_DELETE_METHOD(concurrent_hash_map(concurrent_hash_map const&));
+  MARE_DELETE_METHOD(concurrent_hash_map& operator=(
+                       concurrent_hash_map const&));
+
+  /** Copies the value of key into value, if key is present.
+      @return True if key was found; false otherwise. */
+  bool find(key_type const& key, mapped_type& value) const {
+    return _m.visit(key, [&value](mapped_type const& v) { value = v; });
+  }
+
+  /** @return True if key is present; false otherwise. */
+  bool contains(key_type const& key) const {
+    return _m.visit(key, [](mapped_type const&) {});
+  }
+
+  /** Inserts key with value, unless key is already present.
+      @return True if the element was inserted; false if key was
+      present. */
+  bool insert(key_type const& key, mapped_type const& value) {
+    return _m.insert(key, value, false);
+  }
+
+  /** Inserts key with value, or replaces the value of key if it is
+      present.
+      @return True if the element was inserted; false if it was
+      assigned. */
+  bool insert_or_assign(key_type const& key, mapped_type const& value) {
+    return _m.insert(key, value, true);
+  }
+
+  /** Removes key, if present.
+      @return True if key was removed; false if it was not present. */
+  bool erase(key_type const& key) { return _m.erase(key); }
+
+  /** Returns the number of elements. This is only a snapshot if other
+      tasks modify the map concurrently. */
+  size_t size() const { return _m.size(); }
+
+  /** Returns the current number of buckets. */
+  size_t bucket_count() const { return _m.bucket_count(); }
+
+private:
+  internal::concurrent_hash_map<Key, T, Hash, KeyEqual, Reclamation> _m;
+};
+
+} // namespace mare
+/** @} */ /* end_addtogroup concurrent_hash_map */
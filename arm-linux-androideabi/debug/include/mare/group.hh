@@ -284,8 +284,10 @@ inline void join_group(group_ptr const& group, unsafe_task_ptr const& task)
     those new tasks also complete.  If
     <tt>mare::wait_for(mare::group_ptr)</tt> is called from within a
     task, MARE context switches the task and finds another task to
-    run. If called from outside a task, this function blocks the calling
-    thread until it returns.
+    run. If called from a fiber (see mare::launch_fiber), the fiber is
+    requeued until the group is empty, and the worker runs other tasks
+    in the meantime. If called from outside a task, this function
+    blocks the calling thread until it returns.
 
     Waiting for a group intersection means that MARE returns once the
     tasks in the intersection group have completed or executed.
@@ -313,9 +315,74 @@ inline void wait_for(group_ptr const& group)
 {
   auto g_ptr = internal::c_ptr(group);
   MARE_API_ASSERT(g_ptr, "null group_ptr");
+  if (auto f = internal::current_fiber()) {
+    // Groups have no completion hook for a fiber to resume from.
+    while (!g_ptr->is_empty())
+      f->yield();
+    return;
+  }
   g_ptr->wait();
 }
 
+/**
+    Waits until all the tasks in the group have completed execution or
+    have been canceled, or until a point in time.
+
+    See mare::wait_for(group_ptr const&,
+                       std::chrono::duration<Rep, Period> const&).
+
+    @param group Pointer to group.
+    @param timeout_time Time to wait until.
+
+    @return
+    TRUE -- All tasks in the group finished before timeout_time.\n
+    FALSE -- timeout_time was reached first.
+
+    @throws api_exception If group points to null.
+*/
+template<class Clock, class Duration>
+bool wait_until(group_ptr const& group,
+                std::chrono::time_point<Clock, Duration> const& timeout_time)
+{
+  auto g_ptr = internal::c_ptr(group);
+  MARE_API_ASSERT(g_ptr, "null group_ptr");
+  return internal::poll_until([g_ptr] {
+      return g_ptr->is_empty();
+    }, timeout_time);
+}
+
+/**
+    Waits until all the tasks in the group have completed execution or
+    have been canceled, or for a timeout.
+
+    Returns when the group becomes empty, or once rel_time has passed,
+    whichever comes first. Unlike <tt>wait_for(mare::group_ptr)</tt>,
+    the caller does not block: if called from within a task, the task
+    yields to the MARE scheduler between checks, so the worker thread
+    keeps executing other tasks. The group is not canceled on timeout;
+    call mare::cancel(group_ptr const&) to stop its tasks.
+
+    This method is a safe point.
+
+    @param group Pointer to group.
+    @param rel_time Maximum time to wait.
+
+    @return
+    TRUE -- All tasks in the group finished before the timeout.\n
+    FALSE -- The timeout occurred first.
+
+    @throws api_exception If group points to null.
+
+    @sa mare::wait_until(group_ptr const&,
+                         std::chrono::time_point<Clock, Duration> const&)
+*/
+template<class Rep, class Period>
+bool wait_for(group_ptr const& group,
+              std::chrono::duration<Rep, Period> const& rel_time)
+{
+  return wait_until(group, std::chrono::steady_clock::now() + rel_time);
+}
+
 inline void
 spin_wait_for(group_ptr const& group)
 {
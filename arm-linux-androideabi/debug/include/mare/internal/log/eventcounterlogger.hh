@@ -33,12 +33,18 @@ class event_counter_logger : public logger_base {
 
 public:
 
-#ifndef MARE_USE_EVENT_COUNTER_LOGGER
-  typedef std::false_type enabled;
-#else
+  // Compiled in unless MARE_NO_RUNTIME_LOGGING is defined. Only logs
+  // once enabled at runtime, or from the start if
+  // MARE_USE_EVENT_COUNTER_LOGGER is defined.
+#if defined(MARE_USE_EVENT_COUNTER_LOGGER) || !defined(MARE_NO_RUNTIME_LOGGING)
   typedef std::true_type enabled;
+#else
+  typedef std::false_type enabled;
 #endif
 
+  // Name used to enable the logger at runtime
+  static const char* get_name() { return "event_counter"; }
+
   // Initializes event_counter_logger data structures
   static void init();
 
@@ -88,6 +94,15 @@ private:
 
 }; // class event_counter_logger
 
+// Only counts events, so no sequential ids are needed
+template<>
+struct needs_object_ids<event_counter_logger> : public std::false_type { };
+
+#ifndef MARE_USE_EVENT_COUNTER_LOGGER
+template<>
+struct enabled_by_default<event_counter_logger> : public std::false_type { };
+#endif
+
 } // namespace mare::internal::log
 } // namespace mare::internal
 } // namespace mare
@@ -14,6 +14,8 @@
 // --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
 #pragma once
 
+#include <atomic>
+#include <cstring>
 #include <utility>
 
 #include <mare/internal/debug.hh>
@@ -47,22 +49,48 @@ struct any_logger_enabled<L1, LS...> :
                                   any_logger_enabled<LS...>::value> {
 };
 
+/**
+   These templates check whether any logger needs task and group
+   ids. See needs_object_ids in loggerbase.hh.
+*/
+template<typename ...LS> struct any_logger_needs_object_ids;
+template<>
+struct any_logger_needs_object_ids<> :
+    public std::integral_constant<bool, false> { };
+
+template<typename L1, typename...LS>
+struct any_logger_needs_object_ids<L1, LS...> :
+    public std::integral_constant<bool, (needs_object_ids<L1>::value)?
+                                  true :
+                                  any_logger_needs_object_ids<LS...>::value> {
+};
+
 MARE_GCC_IGNORE_END("-Weffc++");
 
 /**
    These templates are used to call log(), init(), and shutdown()
-   on the enabled loggers
+   on the enabled loggers.
+
+   Loggers are also switched on and off at runtime. Each logger
+   owns one bit of a logger set, in the order of the template
+   parameters: log() and dump() only reach the loggers whose bit is
+   set.
  */
+typedef unsigned int logger_set;
+
 template<typename ...T> struct method_dispatcher;
 
 template<> struct method_dispatcher<> {
   template<typename EVENT>
-  static void log(EVENT&&, event_context&){ };
+  static void log(EVENT&&, event_context&, logger_set){ };
   static void init(){ };
   static void shutdown(){ };
-  static void dump(){ };
+  static void dump(logger_set){ };
   static void pause(){ };
   static void resume(){ };
+  static constexpr logger_set compiled_in() { return 0; }
+  static constexpr logger_set enabled_by_default() { return 0; }
+  static logger_set find(const char*, size_t) { return 0; }
 };
 
 template<typename L1, typename...LS>
@@ -71,19 +99,22 @@ struct method_dispatcher<L1, LS...>
 private:
 
   template<typename EVENT>
-  static void _log(EVENT&& e, event_context& context, std::true_type) {
-    L1::log(std::forward<EVENT>(e), context);
+  static void _log(EVENT&& e, event_context& context, logger_set active,
+                   std::true_type) {
+    if (active & 1)
+      L1::log(std::forward<EVENT>(e), context);
   }
 
   template<typename EVENT>
-  static void _log(EVENT&&, event_context&, std::false_type) {}
+  static void _log(EVENT&&, event_context&, logger_set, std::false_type) {}
 
 public:
 
   template<typename EVENT>
-  static void log(EVENT&& e, event_context& context) {
-    _log(std::forward<EVENT>(e), context, typename L1::enabled());
-    method_dispatcher<LS...>::log(std::forward<EVENT>(e), context);
+  static void log(EVENT&& e, event_context& context, logger_set active) {
+    _log(std::forward<EVENT>(e), context, active, typename L1::enabled());
+    method_dispatcher<LS...>::log(std::forward<EVENT>(e), context,
+                                  active >> 1);
   }
 
   static void init() {
@@ -103,10 +134,10 @@ public:
     method_dispatcher<LS...>::shutdown();
   }
 
-  static void dump() {
-    if (L1::enabled::value)
+  static void dump(logger_set active) {
+    if (L1::enabled::value && (active & 1))
       L1::dump();
-    method_dispatcher<LS...>::dump();
+    method_dispatcher<LS...>::dump(active >> 1);
   }
 
   static void pause() {
@@ -120,6 +151,27 @@ public:
       L1::resumed();
     method_dispatcher<LS...>::resume();
   }
+
+  // Loggers that are compiled in
+  static constexpr logger_set compiled_in() {
+    return (L1::enabled::value ? 1 : 0) |
+      (method_dispatcher<LS...>::compiled_in() << 1);
+  }
+
+  // Loggers that log as soon as the infrastructure is active
+  static constexpr logger_set enabled_by_default() {
+    return (log::enabled_by_default<L1>::value ? 1 : 0) |
+      (method_dispatcher<LS...>::enabled_by_default() << 1);
+  }
+
+  // Returns the bit of the compiled-in logger whose name is the first
+  // len characters of name, or 0 if there is none.
+  static logger_set find(const char* name, size_t len) {
+    if (L1::enabled::value && strlen(L1::get_name()) == len &&
+        strncmp(L1::get_name(), name, len) == 0)
+      return 1;
+    return method_dispatcher<LS...>::find(name, len) << 1;
+  }
 };
 
 
@@ -139,6 +191,11 @@ private:
   typedef typename any_logger_enabled<L1, LN...>::integral_constant
     any_logger_enabled;
 
+  // std::integral_constant<bool, true> if at least one of the enabled
+  // loggers needs sequential task and group ids.
+  typedef typename any_logger_needs_object_ids<L1, LN...>::integral_constant
+    any_logger_needs_object_ids;
+
   // Loggers in the system. We could have use a type list of some
   // sort, but this strategy worked and I felt it was just ok.
   typedef method_dispatcher<L1, LN...> loggers;
@@ -153,7 +210,13 @@ private:
     PAUSED,
     FINISHED
   };
-  static status s_status;
+  static std::atomic<status> s_status;
+
+  // Loggers that are switched on, see set_loggers()
+  static std::atomic<logger_set> s_loggers;
+
+  // Event classes that are logged, see set_event_classes()
+  static std::atomic<event_class_set> s_event_classes;
 
   // Called by event(EVENT&& e) when no logger is enabled, thus making
   // sure that the compiler can optimize everything away if all loggers
@@ -165,26 +228,67 @@ private:
   // Called by event(EVENT&& e) when at least one logger is enabled.
   // Returns immediately if the logging infrastructure is not in
   // ACTIVE mode. This means that we have a dynamic check for
-  // each event logging.
+  // each event logging: a single load and a branch that is always
+  // taken the same way while logging is off. Everything else is kept
+  // out of line so that it does not bloat the callers.
   template<typename EVENT>
   static void _event(EVENT&& e, std::true_type) {
-    if (s_status != status::ACTIVE)
+    if (s_status.load(std::memory_order_relaxed) != status::ACTIVE)
+      return;
+    _log(std::forward<EVENT>(e));
+  }
+
+  template<typename EVENT>
+  MARE_GCC_ATTRIBUTE((noinline))
+  static void _log(EVENT&& e) {
+    typedef typename std::decay<EVENT>::type event_type;
+    if ((s_event_classes.load(std::memory_order_relaxed) &
+         event_type::get_class()) == 0)
+      return;
+    logger_set active = s_loggers.load(std::memory_order_relaxed);
+    if (active == 0)
       return;
 
     event_context context;
-    loggers::log(std::forward<EVENT>(e), context);
+    loggers::log(std::forward<EVENT>(e), context, active);
+  }
+
+  // Parses a comma-separated list of names. Returns false if a name
+  // is unknown to find.
+  template<typename FIND>
+  static bool parse(const char* names, unsigned all, unsigned& result,
+                    FIND&& find) {
+    MARE_API_ASSERT(names != nullptr, "null list of names");
+    result = 0;
+    bool success = true;
+    while (*names != '\0') {
+      size_t len = strcspn(names, ",");
+      if (len == 3 && strncmp(names, "all", len) == 0) {
+        result |= all;
+      } else if (len != 0 &&
+                 !(len == 4 && strncmp(names, "none", len) == 0)) {
+        unsigned bit = find(names, len);
+        if (bit == 0)
+          success = false;
+        result |= bit;
+      }
+      names += len;
+      if (*names == ',')
+        ++names;
+    }
+    return success;
   }
 
 public:
 
   // This template allows us to choose the type of object_id that
-  // we'll use. If no logger is enabled, we'll use
+  // we'll use. If no logger needs ids, we'll use
   // null_log_object_id. Otherwise, we'll use seq_log_object_id.
-  typedef typename std::conditional<any_logger_enabled::value,
+  typedef typename std::conditional<any_logger_needs_object_ids::value,
                                     seq_object_id<task>,
                                     null_object_id<task>>::type task_id;
 
-  typedef typename std::conditional<any_logger_enabled::value,
+  typedef typename std::conditional<any_logger_needs_object_ids::value,
                                     seq_object_id<group>,
                                     null_object_id<group>>::type group_id;
 
@@ -194,14 +298,14 @@ public:
   // ignored.
   static void init() {
     if(any_logger_enabled::value == false ||
-       s_status != status::UNINITIALIZED)
+       s_status.load() != status::UNINITIALIZED)
       return;
 
     static_assert(duplicated_types<L1, LN...>::value == false,
                   "\nDuplicated logger types in logging infrastructure.");
 
     loggers::init();
-    s_status = status::ACTIVE;
+    s_status.store(status::ACTIVE);
   }
 
   // Shuts the logging infrastructure down by calling shutdown() on
@@ -210,51 +314,88 @@ public:
   // be ignored.
   static void shutdown() {
     if(any_logger_enabled::value == false ||
-       s_status == status::UNINITIALIZED ||
-       s_status == status::FINISHED)
+       s_status.load() == status::UNINITIALIZED ||
+       s_status.load() == status::FINISHED)
       return;
 
     loggers::shutdown();
-    s_status = status::FINISHED;
+    s_status.store(status::FINISHED);
   }
 
-  // Pauses logging. Causes a transtition to PAUSED state.
+  // Pauses logging. Causes a transtition to PAUSED state. Now that
+  // logging can be started and stopped at runtime, only an ACTIVE
+  // infrastructure can be paused.
   static void pause() {
     if (any_logger_enabled::value == false ||
-        s_status == status::PAUSED)
+        s_status.load() != status::ACTIVE)
       return;
-    s_status = status::PAUSED;
+    s_status.store(status::PAUSED);
     loggers::pause();
   }
 
-  // Resumes logging.  Causes a transtition to LOGGING state.
+  // Resumes logging.  Causes a transtition to LOGGING state. Only a
+  // PAUSED infrastructure can be resumed.
   static void resume() {
     if(any_logger_enabled::value == false ||
-       s_status == status::ACTIVE)
+       s_status.load() != status::PAUSED)
       return;
 
-    s_status = status::ACTIVE;
+    s_status.store(status::ACTIVE);
     loggers::resume();
   }
 
   // Returns true if the logging has been initialized but not shut
   // down yet.
   static bool is_initialized() {
-    return (s_status == status::ACTIVE) || (s_status == status::PAUSED);
+    status s = s_status.load();
+    return (s == status::ACTIVE) || (s == status::PAUSED);
   }
 
   // Returns true if the logging is in ACTIVE state.
   static bool is_active() {
-    return (s_status == status::ACTIVE);
+    return (s_status.load() == status::ACTIVE);
   }
 
   // Returns true if the logging is in PAUSED state.
   static bool is_paused() {
-    return (s_status == status::PAUSED);
+    return (s_status.load() == status::PAUSED);
   }
 
   static void dump() {
-    loggers::dump();
+    loggers::dump(s_loggers.load(std::memory_order_relaxed));
+  }
+
+  // Switches on the loggers in names, a comma-separated list of
+  // logger names (see get_name() in each logger), "all" or "none",
+  // and switches off the rest. Loggers that are not compiled in
+  // cannot be switched on. Returns false if a name is unknown; the
+  // known names take effect anyway.
+  static bool set_loggers(const char* names) {
+    logger_set set;
+    bool success = parse(names, loggers::compiled_in(), set,
+                         [](const char* name, size_t len) {
+                           return loggers::find(name, len);
+                         });
+    s_loggers.store(set, std::memory_order_relaxed);
+    return success;
+  }
+
+  // Switches on the logger with the given name, keeping the others.
+  static bool enable_logger(const char* name) {
+    logger_set bit = loggers::find(name, strlen(name));
+    s_loggers.fetch_or(bit, std::memory_order_relaxed);
+    return bit != 0;
+  }
+
+  // Logs only events of the classes in names, a comma-separated list
+  // of "group", "task", "refcount", "sdf", "pfor" and "runtime", or
+  // "all" or "none". Returns false if a name is unknown; the known
+  // names take effect anyway.
+  static bool set_event_classes(const char* names) {
+    event_class_set set;
+    bool success = parse(names, event_class::all, set, find_event_class);
+    s_event_classes.store(set, std::memory_order_relaxed);
+    return success;
   }
 
   // Logs event e.
@@ -273,9 +414,18 @@ public:
 
 // Static members initialization
 template <typename L1, typename ...LN>
-typename infrastructure<L1, LN...>::status
-  infrastructure<L1, LN...>::s_status =
-  infrastructure::status::UNINITIALIZED;
+std::atomic<typename infrastructure<L1, LN...>::status>
+  infrastructure<L1, LN...>::s_status(
+  infrastructure::status::UNINITIALIZED);
+
+template <typename L1, typename ...LN>
+std::atomic<logger_set>
+  infrastructure<L1, LN...>::s_loggers(
+  method_dispatcher<L1, LN...>::enabled_by_default());
+
+template <typename L1, typename ...LN>
+std::atomic<event_class_set>
+  infrastructure<L1, LN...>::s_event_classes(event_class::all);
 
 } // mare::internal::log
 } // mare::internal
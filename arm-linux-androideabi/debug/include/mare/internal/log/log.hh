@@ -14,10 +14,13 @@
 // --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
 #pragma once
 
+#include <cstdlib>
+
 #include <mare/internal/log/eventcounterlogger.hh>
-// Enable the ftrace logger only for Android and Linux
+// Enable the ftrace and trace loggers only for Android and Linux
 #if defined(__ANDROID__) || defined(__linux__)
 #include <mare/internal/log/ftracelogger.hh>
+#include <mare/internal/log/tracelogger.hh>
 #endif
 #include <mare/internal/log/infrastructure.hh>
 #include <mare/internal/log/imlogger.hh>
@@ -32,7 +35,7 @@ namespace log {
 //ToDo: Transition to a typelist
 #if defined(__ANDROID__) || defined(__linux__)
 typedef infrastructure<imlogger, event_counter_logger, ftrace_logger,
-                       pfor_logger> loggers;
+                       pfor_logger, trace_logger> loggers;
 #else
 typedef infrastructure<imlogger, event_counter_logger, pfor_logger> loggers;
 #endif
@@ -55,6 +58,26 @@ inline void log_event(EVENT&& e) {
   loggers::event(std::forward<EVENT>(e));
 }
 
+// Configures logging from the environment. MARE_LOG_EVENTS selects
+// the event classes to log. If MARE_LOGGERS is set, the loggers it
+// lists are switched on, logging starts right away, and the loggers
+// dump their results when the process exits. Called by
+// mare::runtime::init().
+inline void init_from_environment() {
+  if (const char* classes = std::getenv("MARE_LOG_EVENTS")) {
+    if (!loggers::set_event_classes(classes))
+      MARE_WLOG("Unknown event class in MARE_LOG_EVENTS=%s", classes);
+  }
+
+  const char* names = std::getenv("MARE_LOGGERS");
+  if (names == nullptr || loggers::is_initialized())
+    return;
+  if (!loggers::set_loggers(names))
+    MARE_WLOG("Unknown or disabled logger in MARE_LOGGERS=%s", names);
+  loggers::init();
+  std::atexit([] { loggers::dump(); });
+}
+
 } // mare::internal::log
 } // mare::internal
 } // mare
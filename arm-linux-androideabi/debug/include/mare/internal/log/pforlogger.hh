@@ -35,12 +35,18 @@ public:
 
   static const auto relaxed = std::memory_order_relaxed;
 
-#ifndef MARE_USE_PFOR_LOGGER
-  typedef std::false_type enabled;
-#else
+  // Compiled in unless MARE_NO_RUNTIME_LOGGING is defined. Only logs
+  // once enabled at runtime, or from the start if
+  // MARE_USE_PFOR_LOGGER is defined.
+#if defined(MARE_USE_PFOR_LOGGER) || !defined(MARE_NO_RUNTIME_LOGGING)
   typedef std::true_type enabled;
+#else
+  typedef std::false_type enabled;
 #endif
 
+  // Name used to enable the logger at runtime
+  static const char* get_name() { return "pfor"; }
+
   // Initializes pfor_logger data structures
   static void init();
 
@@ -107,6 +113,15 @@ private:
 
 }; // class pfor_logger
 
+// Only counts events, so no sequential ids are needed
+template<>
+struct needs_object_ids<pfor_logger> : public std::false_type { };
+
+#ifndef MARE_USE_PFOR_LOGGER
+template<>
+struct enabled_by_default<pfor_logger> : public std::false_type { };
+#endif
+
 } // namespace mare::internal::log
 } // namespace mare::internal
 } // namespace mare
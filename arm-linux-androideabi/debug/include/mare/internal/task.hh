@@ -14,15 +14,19 @@
 // --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 #include <mare/attr.hh>
 #include <mare/exceptions.hh>
 #include <mare/internal/compat.h>
 #include <mare/internal/debug.hh>
+#include <mare/internal/fibercontext.hh>
 #include <mare/internal/log/log.hh>
 #include <mare/internal/macros.hh>
 #include <mare/internal/mareptrs.hh>
@@ -751,12 +755,17 @@ task::execute_inline(group* g_ptr = nullptr) {
 ///
 /// \par
 /// This function has no effect if called outside of a MARE task.
+/// Inside a fiber, requeues the fiber instead.
 ///
 /// \par
 /// NOTE: The ability to yield may go away in future releases of MARE.
 inline void
 yield()
 {
+  if (auto f = current_fiber()) {
+    f->yield();
+    return;
+  }
   if (auto task = current_task()) {
     auto t_ptr = c_ptr(task);
     MARE_API_ASSERT(t_ptr, "null task_ptr");
@@ -764,6 +773,42 @@ yield()
   }
 }
 
+/// \brief Waits until done() returns true or timeout_time is reached
+///
+/// Used for the timed waits, which cannot block in a futex because
+/// blocked tasks cannot be woken up by a timeout. Inside a task, yields
+/// to the scheduler between polls, so the worker keeps executing other
+/// tasks. Outside, sleeps between polls, doubling the delay from 10us up
+/// to 1ms and never past timeout_time, so that a long wait does not keep
+/// a core busy.
+///
+/// \return done() after the last poll.
+template<typename Done, typename Clock, typename Duration>
+bool
+poll_until(Done done,
+           std::chrono::time_point<Clock, Duration> const& timeout_time)
+{
+  std::chrono::microseconds delay(10);
+  std::chrono::microseconds const max_delay(1000);
+  while (!done()) {
+    auto now = Clock::now();
+    if (now >= timeout_time)
+      return done();
+    if (current_task()) {
+      yield();
+      continue;
+    }
+    auto remaining = timeout_time - now;
+    if (remaining < delay)
+      std::this_thread::sleep_for(remaining);
+    else
+      std::this_thread::sleep_for(delay);
+    if (delay < max_delay)
+      delay = std::min(delay * 2, max_delay);
+  }
+  return true;
+}
+
 };//namespace internal
 };//namespace mare
 
@@ -0,0 +1,107 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/pageallocator.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::page_allocator and
+//     mare::parallel_first_touch, and
+//  2. compare base pages and huge pages on random reads from a large
+//     array.
+//
+//  Each configuration allocates num_elements doubles, initializes them
+//  (serially, or in parallel with first touch), and then sums
+//  num_reads pseudo-random elements in parallel. Random reads miss the
+//  TLB on almost every access with base pages; huge pages cover 512
+//  times as much memory per TLB entry. On a NUMA machine, parallel first
+//  touch additionally spreads the array over the nodes of the workers.
+
+const std::size_t num_elements = std::size_t(1) << 25;   // 256 MiB
+const std::size_t num_reads = std::size_t(1) << 24;
+const std::size_t num_chunks = 256;
+
+template<typename Allocator>
+double
+random_reads(double const* data)
+{
+  std::vector<double> sums(num_chunks);
+  auto start = std::chrono::system_clock::now();
+  mare::pfor_each(std::size_t(0), num_chunks, [data, &sums] (std::size_t c) {
+      std::uint64_t x = 0x9e3779b97f4a7c15ULL * (c + 1);
+      double sum = 0;
+      for (std::size_t i = 0; i < num_reads / num_chunks; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += data[x & (num_elements - 1)];
+      }
+      sums[c] = sum;
+    });
+  auto end = std::chrono::system_clock::now();
+  MARE_UNUSED(sums);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+template<typename Allocator>
+void
+run(const char* name, bool parallel_init, mare::huge_pages pages)
+{
+  Allocator a;
+  auto start = std::chrono::system_clock::now();
+  double* data = a.allocate(num_elements);
+  if (parallel_init)
+    mare::parallel_first_touch(data, data + num_elements, 1.0, pages);
+  else
+    std::uninitialized_fill(data, data + num_elements, 1.0);
+  auto end = std::chrono::system_clock::now();
+
+  double init = std::chrono::duration<double>(end - start).count();
+  double reads = random_reads<Allocator>(data);
+  MARE_LLOG("%-28s %8.4f s %8.4f s", name, init, reads);
+  a.deallocate(data, num_elements);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("%-28s %10s %10s", "allocator", "init", "reads");
+  run< std::allocator<double> >("std::allocator", false,
+                                mare::huge_pages::none);
+  run< mare::page_allocator<double, mare::huge_pages::none> >
+    ("base pages, first touch", true, mare::huge_pages::none);
+  run< mare::page_allocator<double, mare::huge_pages::transparent> >
+    ("huge pages, first touch", true, mare::huge_pages::transparent);
+  run< mare::page_allocator<double, mare::huge_pages::transparent,
+                            mare::numa_placement::interleave> >
+    ("huge pages, interleaved", false, mare::huge_pages::transparent);
+  run< mare::page_allocator<double, mare::huge_pages::hugetlb> >
+    ("hugetlb, first touch", true, mare::huge_pages::hugetlb);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <mare/internal/tlsptr.hh>
+
+namespace mare {
+
+namespace internal {
+
+class task;
+
+/// Suspension points of the fiber running on the current thread.
+///
+/// The waits of the MARE API check current_fiber() first. Inside a
+/// fiber, they suspend the fiber instead of blocking the worker, which
+/// goes on to run other tasks. See internal/fiber.hh.
+class fiber_context {
+public:
+  /// Suspends the fiber until t has completed or has been canceled.
+  virtual void wait_for(task* t) = 0;
+
+  /// Suspends the fiber and requeues it behind the ready tasks.
+  virtual void yield() = 0;
+
+protected:
+  ~fiber_context() { }
+};
+
+/// Never destroyed, so that ~tlsptr(), which may throw, is not
+/// instantiated in every translation unit that includes mare.h.
+inline tlsptr<fiber_context>&
+current_fiber_slot()
+{
+  static tlsptr<fiber_context>* s_current = new tlsptr<fiber_context>();
+  return *s_current;
+}
+
+/// Returns the fiber running on this thread, or nullptr.
+inline fiber_context*
+current_fiber()
+{
+  return current_fiber_slot().get();
+}
+
+} //namespace internal
+
+} //namespace mare
@@ -40,6 +40,9 @@ public:
   typedef std::true_type enabled;
 #endif
 
+  // Name used to enable the logger at runtime
+  static const char* get_name() { return "ftrace"; }
+
   // Initializes ftrace_logger data structures
   static void init();
 
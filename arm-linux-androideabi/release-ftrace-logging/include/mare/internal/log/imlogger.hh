@@ -43,6 +43,9 @@ public:
   typedef std::true_type enabled;
 #endif
 
+  // Name used to enable the logger at runtime
+  static const char* get_name() { return "imlogger"; }
+
   // Initializes imlogger data structures
   static void init();
 
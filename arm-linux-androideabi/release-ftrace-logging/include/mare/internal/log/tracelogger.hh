@@ -0,0 +1,500 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/log/loggerbase.hh>
+#include <mare/internal/tlsptr.hh>
+
+namespace mare {
+namespace internal {
+namespace log {
+
+/// Events kept by trace_logger.
+enum class trace_kind : uint32_t {
+  group_canceled,
+  group_created,
+  group_destroyed,
+  sdf_node_done,
+  sdf_node_executes,
+  task_after,
+  task_created,
+  task_done,
+  task_executes,
+  ws_tree_try_steal_success,
+  ws_tree_worker_try_steal
+};
+
+/// An event as read back from a trace_ring.
+struct trace_record {
+  uint64_t _time;
+  trace_kind _kind;
+  uintptr_t _object;
+  uintptr_t _other;
+};
+
+///
+/// Fixed-size ring of trace events written by one thread.
+///
+/// Only the owner thread pushes, without locks or read-modify-writes;
+/// once the ring is full, the oldest events are overwritten. Any thread
+/// may read the ring with for_each() while the owner keeps pushing.
+/// Every slot carries a sequence number, seqlock style: the writer
+/// clears it, writes the payload and then stores the position of the
+/// event plus one. The reader keeps a slot only if it sees that same
+/// sequence number before and after copying the payload; otherwise the
+/// writer has lapped the reader and the slot is skipped.
+///
+class trace_ring {
+public:
+  trace_ring(size_t capacity, size_t tid) :
+    _slots(new slot[capacity]),
+    _mask(capacity - 1),
+    _tid(tid),
+    _head(0),
+    _next(nullptr) {
+    MARE_INTERNAL_ASSERT(capacity > 0 && (capacity & _mask) == 0,
+                         "ring capacity must be a power of two: %zu",
+                         capacity);
+    for (size_t i = 0; i < capacity; ++i)
+      _slots[i]._seq.store(0, std::memory_order_relaxed);
+  }
+
+  MARE_DELETE_METHOD(trace_ring(trace_ring const&));
+  MARE_DELETE_METHOD(trace_ring& operator=(trace_ring const&));
+
+  size_t get_tid() const { return _tid; }
+
+  size_t get_capacity() const { return _mask + 1; }
+
+  /// Called by the owner thread only.
+  void push(trace_kind kind, uint64_t time,
+            void const* object, void const* other) {
+    auto const relaxed = std::memory_order_relaxed;
+    uint64_t pos = _head.load(relaxed);
+    slot& s = _slots[pos & _mask];
+    s._seq.store(0, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s._time.store(time, relaxed);
+    s._kind.store(static_cast<uint32_t>(kind), relaxed);
+    s._object.store(reinterpret_cast<uintptr_t>(object), relaxed);
+    s._other.store(reinterpret_cast<uintptr_t>(other), relaxed);
+    s._seq.store(pos + 1, std::memory_order_release);
+    _head.store(pos + 1, std::memory_order_release);
+  }
+
+  /// Calls f(trace_record const&) on the events in the ring, oldest
+  /// first.
+  template<typename F>
+  void for_each(F&& f) const {
+    auto const relaxed = std::memory_order_relaxed;
+    uint64_t head = _head.load(std::memory_order_acquire);
+    uint64_t first = head > get_capacity() ? head - get_capacity() : 0;
+    for (uint64_t pos = first; pos < head; ++pos) {
+      slot const& s = _slots[pos & _mask];
+      uint64_t seq = s._seq.load(std::memory_order_acquire);
+      trace_record r;
+      r._time = s._time.load(relaxed);
+      r._kind = static_cast<trace_kind>(s._kind.load(relaxed));
+      r._object = s._object.load(relaxed);
+      r._other = s._other.load(relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq != pos + 1 || s._seq.load(relaxed) != seq)
+        continue;
+      f(r);
+    }
+  }
+
+private:
+  struct slot {
+    std::atomic<uint64_t> _seq;
+    std::atomic<uint64_t> _time;
+    std::atomic<uint32_t> _kind;
+    std::atomic<uintptr_t> _object;
+    std::atomic<uintptr_t> _other;
+  };
+
+  std::unique_ptr<slot[]> _slots;
+  size_t const _mask;
+  size_t const _tid;
+  std::atomic<uint64_t> _head;
+
+public:
+  /// Next ring in trace_logger's list of rings.
+  trace_ring* _next;
+};
+
+/**
+   Records MARE events in per-thread rings and writes them out in the
+   Chrome trace event format, which chrome://tracing and Perfetto load.
+
+   Task and SDF node executions become duration events on the thread
+   that ran them; creations, dependencies, group events and steals
+   become instant events. Objects are identified by their address, so
+   enabling this logger does not require sequential task and group ids
+   (see needs_object_ids).
+
+   Rings are allocated the first time a thread logs an event and are
+   never freed, so that the events of threads that have already exited
+   are still written out.
+*/
+class trace_logger : public logger_base {
+
+public:
+
+  // Compiled in unless MARE_NO_RUNTIME_LOGGING is defined. Only logs
+  // once enabled at runtime, or from the start if
+  // MARE_USE_TRACE_LOGGER is defined.
+#if defined(MARE_USE_TRACE_LOGGER) || !defined(MARE_NO_RUNTIME_LOGGING)
+  typedef std::true_type enabled;
+#else
+  typedef std::false_type enabled;
+#endif
+
+  // Name used to enable the logger at runtime
+  static const char* get_name() { return "trace"; }
+
+  static const size_t default_ring_size = 16384;
+
+  static void init() { }
+
+  static void shutdown() { }
+
+  // Writes the trace to the file set with set_path(), by default
+  // $MARE_TRACE_FILE or mare_trace.json
+  static void dump() {
+    std::string path;
+    {
+      std::lock_guard<std::mutex> lock(get_state()._mutex);
+      path = get_state()._path;
+    }
+    write_trace(path.c_str());
+  }
+
+  // Logging infrastructure has been paused
+  static void paused() { }
+
+  // Logging infrastructure has been resumed
+  static void resumed() { }
+
+  // Logs event. Because we want events as inlined as possible, the
+  // implementation for the method is in this file
+  template<typename EVENT>
+  static void log(EVENT&& e, event_context& context) {
+    record(std::forward<EVENT>(e), context);
+  }
+
+  // Sets the number of events kept per thread. Rounded up to a power
+  // of two. Rings that already exist keep their capacity.
+  static void set_ring_size(size_t events) {
+    size_t capacity = 1;
+    while (capacity < events)
+      capacity <<= 1;
+    get_state()._ring_size.store(capacity, std::memory_order_relaxed);
+  }
+
+  // Sets the file dump() writes to
+  static void set_path(const char* path) {
+    MARE_API_ASSERT(path != nullptr, "null trace path");
+    std::lock_guard<std::mutex> lock(get_state()._mutex);
+    get_state()._path = path;
+  }
+
+  // Writes the events in all rings to path. Returns false if the
+  // file cannot be written.
+  static bool write_trace(const char* path) {
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s._mutex);
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+      MARE_WLOG("Unable to open trace file %s", path);
+      return false;
+    }
+    long pid = static_cast<long>(getpid());
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    const char* sep = "\n";
+    for (trace_ring* r = s._head.load(); r != nullptr; r = r->_next) {
+      size_t tid = r->get_tid();
+      fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\","
+              "\"pid\":%ld,\"tid\":%zu,"
+              "\"args\":{\"name\":\"mare thread %zu\"}}",
+              sep, pid, tid, tid);
+      sep = ",\n";
+      // The oldest events of a full ring may be the ends of executions
+      // whose beginnings were overwritten. Skip them.
+      size_t depth = 0;
+      r->for_each([&](trace_record const& e) {
+          if (is_end(e._kind)) {
+            if (depth == 0)
+              return;
+            --depth;
+          } else if (is_begin(e._kind)) {
+            ++depth;
+          }
+          fprintf(file, ",\n");
+          write_event(file, e, pid, tid);
+        });
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+  }
+
+  // Writes the trace to the file set with set_path() whenever the
+  // process receives signo. The signal handler only wakes up a
+  // helper thread, which does the writing.
+  static void dump_on_signal(int signo) {
+    auto& s = get_state();
+    {
+      std::lock_guard<std::mutex> lock(s._mutex);
+      if (s._signal_fd.load() < 0) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+          MARE_WLOG("Unable to create trace signal pipe: %d", errno);
+          return;
+        }
+        std::thread(flush_on_signal, fds[0]).detach();
+        s._signal_fd.store(fds[1]);
+      }
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(signo, &action, nullptr);
+  }
+
+private:
+
+  struct state {
+    state() :
+      _head(nullptr),
+      _ring(*new tlsptr<trace_ring>()),
+      _num_rings(0),
+      _ring_size(default_ring_size),
+      _signal_fd(-1),
+      _mutex(),
+      _path(getenv("MARE_TRACE_FILE") != nullptr ?
+            getenv("MARE_TRACE_FILE") : "mare_trace.json") { }
+
+    std::atomic<trace_ring*> _head;
+    // Never destroyed either, so that ~tlsptr(), which may throw, is not
+    // instantiated in every translation unit.
+    tlsptr<trace_ring>& _ring;
+    std::atomic<size_t> _num_rings;
+    std::atomic<size_t> _ring_size;
+    std::atomic<int> _signal_fd;
+    // Serializes writers of the trace file and accesses to _path
+    std::mutex _mutex;
+    std::string _path;
+
+    MARE_DELETE_METHOD(state(state const&));
+    MARE_DELETE_METHOD(state& operator=(state const&));
+  };
+
+  // Never destroyed: threads may still log events while the process
+  // exits.
+  static state& get_state() {
+    static state* s_state = new state();
+    return *s_state;
+  }
+
+  static trace_ring& get_ring() {
+    auto& s = get_state();
+    trace_ring* r = s._ring;
+    if (r != nullptr)
+      return *r;
+
+    r = new trace_ring(s._ring_size.load(std::memory_order_relaxed),
+                       s._num_rings.fetch_add(1));
+    trace_ring* head = s._head.load();
+    do {
+      r->_next = head;
+    } while (!s._head.compare_exchange_weak(head, r));
+    s._ring = r;
+    return *r;
+  }
+
+  static void push(trace_kind kind, event_context& context,
+                   void const* object, void const* other = nullptr) {
+    get_ring().push(kind, context.get_time(), object, other);
+  }
+
+  static void record(events::group_canceled&& e, event_context& c) {
+    push(trace_kind::group_canceled, c, e.get_group());
+  }
+
+  static void record(events::group_created&& e, event_context& c) {
+    push(trace_kind::group_created, c, e.get_group());
+  }
+
+  static void record(events::group_destroyed&& e, event_context& c) {
+    push(trace_kind::group_destroyed, c, e.get_group());
+  }
+
+  static void record(events::sdf_node_done&& e, event_context& c) {
+    push(trace_kind::sdf_node_done, c, e.get_node());
+  }
+
+  static void record(events::sdf_node_executes&& e, event_context& c) {
+    push(trace_kind::sdf_node_executes, c, e.get_node());
+  }
+
+  static void record(events::task_after&& e, event_context& c) {
+    push(trace_kind::task_after, c, e.get_pred(), e.get_succ());
+  }
+
+  static void record(events::task_created&& e, event_context& c) {
+    push(trace_kind::task_created, c, e.get_task());
+  }
+
+  static void record(events::task_done&& e, event_context& c) {
+    push(trace_kind::task_done, c, e.get_task());
+  }
+
+  static void record(events::task_executes&& e, event_context& c) {
+    push(trace_kind::task_executes, c, e.get_task());
+  }
+
+  static void record(events::ws_tree_try_steal_success&&, event_context& c) {
+    push(trace_kind::ws_tree_try_steal_success, c, nullptr);
+  }
+
+  static void record(events::ws_tree_worker_try_steal&&, event_context& c) {
+    push(trace_kind::ws_tree_worker_try_steal, c, nullptr);
+  }
+
+  template<typename UnknownEvent>
+  static void record(UnknownEvent&&, event_context&) { }
+
+  static bool is_begin(trace_kind k) {
+    return k == trace_kind::task_executes ||
+      k == trace_kind::sdf_node_executes;
+  }
+
+  static bool is_end(trace_kind k) {
+    return k == trace_kind::task_done || k == trace_kind::sdf_node_done;
+  }
+
+  static const char* get_name(trace_kind k) {
+    switch (k) {
+    case trace_kind::group_canceled: return "group_canceled";
+    case trace_kind::group_created: return "group_created";
+    case trace_kind::group_destroyed: return "group_destroyed";
+    case trace_kind::sdf_node_done:
+    case trace_kind::sdf_node_executes: return "sdf_node";
+    case trace_kind::task_after: return "task_after";
+    case trace_kind::task_created: return "task_created";
+    case trace_kind::task_done:
+    case trace_kind::task_executes: return "task";
+    case trace_kind::ws_tree_try_steal_success: return "steal_success";
+    case trace_kind::ws_tree_worker_try_steal: return "try_steal";
+    }
+    return "unknown";
+  }
+
+  static const char* get_category(trace_kind k) {
+    switch (k) {
+    case trace_kind::group_canceled:
+    case trace_kind::group_created:
+    case trace_kind::group_destroyed: return "group";
+    case trace_kind::sdf_node_done:
+    case trace_kind::sdf_node_executes: return "sdf";
+    case trace_kind::ws_tree_try_steal_success:
+    case trace_kind::ws_tree_worker_try_steal: return "steal";
+    case trace_kind::task_after:
+    case trace_kind::task_created:
+    case trace_kind::task_done:
+    case trace_kind::task_executes: return "task";
+    }
+    return "unknown";
+  }
+
+  static void write_event(FILE* file, trace_record const& e,
+                          long pid, size_t tid) {
+    const char* phase = is_begin(e._kind) ? "B" :
+      (is_end(e._kind) ? "E" : "i");
+    fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\","
+            "\"ts\":%llu.%03llu,\"pid\":%ld,\"tid\":%zu",
+            get_name(e._kind), get_category(e._kind), phase,
+            static_cast<unsigned long long>(e._time / 1000),
+            static_cast<unsigned long long>(e._time % 1000),
+            pid, tid);
+    if (*phase == 'i')
+      fprintf(file, ",\"s\":\"t\"");
+    if (e._kind == trace_kind::task_after)
+      fprintf(file, ",\"args\":{\"pred\":\"%p\",\"succ\":\"%p\"}",
+              reinterpret_cast<void*>(e._object),
+              reinterpret_cast<void*>(e._other));
+    else if (e._object != 0)
+      fprintf(file, ",\"args\":{\"%s\":\"%p\"}", get_category(e._kind),
+              reinterpret_cast<void*>(e._object));
+    fprintf(file, "}");
+  }
+
+  static void signal_handler(int) {
+    int saved_errno = errno;
+    char c = 0;
+    if (write(get_state()._signal_fd.load(), &c, 1) < 0) { }
+    errno = saved_errno;
+  }
+
+  static void flush_on_signal(int fd) {
+    char c;
+    for (;;) {
+      ssize_t n = read(fd, &c, 1);
+      if (n == 1)
+        dump();
+      else if (n < 0 && errno == EINTR)
+        continue;
+      else
+        return;
+    }
+  }
+
+  MARE_DELETE_METHOD(trace_logger());
+  MARE_DELETE_METHOD(trace_logger(trace_logger const&));
+  MARE_DELETE_METHOD(trace_logger(trace_logger&&));
+  MARE_DELETE_METHOD(trace_logger& operator=(trace_logger const&));
+  MARE_DELETE_METHOD(trace_logger& operator=(trace_logger&&));
+
+}; // class trace_logger
+
+// Events are keyed by address, so no sequential ids are needed
+template<>
+struct needs_object_ids<trace_logger> : public std::false_type { };
+
+#ifndef MARE_USE_TRACE_LOGGER
+template<>
+struct enabled_by_default<trace_logger> : public std::false_type { };
+#endif
+
+} // namespace mare::internal::log
+} // namespace mare::internal
+} // namespace mare
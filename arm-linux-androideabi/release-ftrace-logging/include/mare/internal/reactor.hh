@@ -0,0 +1,267 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <mare/exceptions.hh>
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Process-wide epoll reactor.
+///
+/// A single thread blocks in epoll_wait() and runs the callbacks of the
+/// file descriptors that become ready. All descriptors are registered
+/// with EPOLLONESHOT, so every readiness event is reported to exactly one
+/// epoll_wait() call, and the descriptor is rearmed with MOD only while
+/// it still has waiters. Callbacks are collected under _mutex for all the
+/// events returned by one epoll_wait() call and run as one batch after
+/// _mutex is released; they are expected to be short (e.g., launch a
+/// task), because they run on the reactor thread.
+///
+/// epoll cannot poll regular files, which are always ready. arm() reports
+/// them to the caller, which can instead post() the blocking call to the
+/// reactor thread.
+///
+/// Closing a descriptor drops it from the epoll set, but not from _fds.
+/// If the descriptor number is reused, the next arm() on it finds the
+/// stale entry, and its waiters run on the first event of the new file.
+class reactor {
+public:
+  enum event {
+    readable = 0,
+    writable = 1
+  };
+
+  typedef std::function<void()> callback;
+
+  static reactor& instance()
+  {
+    static reactor s_reactor;
+    return s_reactor;
+  }
+
+  /// Calls cb on the reactor thread once fd is ready for ev. Returns
+  /// false, and drops cb, if fd is a regular file or another descriptor
+  /// that is always ready.
+  ///
+  /// @throws api_exception If fd is not a valid descriptor.
+  bool arm(int fd, event ev, callback cb)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _fds.find(fd);
+    bool added = it == _fds.end();
+    if (added)
+      it = _fds.emplace(fd, interest()).first;
+    it->second._waiters[ev].push_back(std::move(cb));
+
+    int err = update(fd, it->second, added);
+    if (err == 0)
+      return true;
+
+    it->second._waiters[ev].pop_back();
+    if (it->second.empty())
+      _fds.erase(it);
+    MARE_API_ASSERT(err == EPERM, "cannot poll fd %d: %s", fd,
+                    strerror(err));
+    return false;
+  }
+
+  /// Runs cb on the reactor thread as soon as possible.
+  void post(callback cb)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _posted.push_back(std::move(cb));
+    }
+    wake();
+  }
+
+  ~reactor()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    wake();
+    _thread.join();
+    close(_wake[0]);
+    close(_wake[1]);
+    close(_epfd);
+  }
+
+private:
+  static const int MAX_EVENTS = 64;
+
+  struct interest {
+    std::vector<callback> _waiters[2];
+
+    bool empty() const
+    {
+      return _waiters[readable].empty() && _waiters[writable].empty();
+    }
+
+    uint32_t mask() const
+    {
+      return EPOLLONESHOT |
+        (_waiters[readable].empty() ? 0 : uint32_t(EPOLLIN)) |
+        (_waiters[writable].empty() ? 0 : uint32_t(EPOLLOUT));
+    }
+  };
+
+  reactor() :
+    _epfd(epoll_create(MAX_EVENTS)),
+    _wake(),
+    _mutex(),
+    _fds(),
+    _posted(),
+    _stop(false),
+    _thread()
+  {
+    if (_epfd < 0 || pipe(_wake) != 0)
+      MARE_FATAL("reactor setup failed: %s", strerror(errno));
+    fcntl(_epfd, F_SETFD, FD_CLOEXEC);
+    for (int fd : _wake)
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(_wake[0], F_SETFL, O_NONBLOCK);
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = _wake[0];
+    if (epoll_ctl(_epfd, EPOLL_CTL_ADD, _wake[0], &ev) != 0)
+      MARE_FATAL("reactor setup failed: %s", strerror(errno));
+    _thread = std::thread(&reactor::run, this);
+  }
+
+  void wake()
+  {
+    char c = 0;
+    while (write(_wake[1], &c, 1) < 0 && errno == EINTR) { }
+  }
+
+  /// Registers the interest of fd with epoll. Returns 0 or an errno.
+  int update(int fd, interest const& i, bool added)
+  {
+    epoll_event ev;
+    ev.events = i.mask();
+    ev.data.fd = fd;
+    int op = added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (epoll_ctl(_epfd, op, fd, &ev) == 0)
+      return 0;
+    // A stale entry in _fds, or one that a previous ADD left in epoll.
+    if (errno == ENOENT || errno == EEXIST) {
+      op = added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+      if (epoll_ctl(_epfd, op, fd, &ev) == 0)
+        return 0;
+    }
+    return errno;
+  }
+
+  void run()
+  {
+    epoll_event events[MAX_EVENTS];
+    std::vector<callback> batch;
+    while (true) {
+      int n = epoll_wait(_epfd, events, MAX_EVENTS, -1);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        MARE_FATAL("epoll_wait failed: %s", strerror(errno));
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (int k = 0; k < n; ++k) {
+          int fd = events[k].data.fd;
+          if (fd == _wake[0]) {
+            char buf[64];
+            while (read(fd, buf, sizeof(buf)) > 0) { }
+            continue;
+          }
+          collect(fd, events[k].events, batch);
+        }
+        if (_stop)
+          return;
+        for (auto& cb : _posted)
+          batch.push_back(std::move(cb));
+        _posted.clear();
+      }
+
+      for (auto& cb : batch)
+        cb();
+      batch.clear();
+    }
+  }
+
+  /// Moves the waiters that ev satisfies into batch, and rearms or
+  /// deregisters fd. Errors and hangups satisfy all waiters, so that they
+  /// can find out with their next read or write.
+  void collect(int fd, uint32_t ev, std::vector<callback>& batch)
+  {
+    auto it = _fds.find(fd);
+    if (it == _fds.end())
+      return;
+    interest& i = it->second;
+    uint32_t const any = EPOLLERR | EPOLLHUP;
+    if (ev & (EPOLLIN | any))
+      take(i._waiters[readable], batch);
+    if (ev & (EPOLLOUT | any))
+      take(i._waiters[writable], batch);
+
+    if (i.empty()) {
+      epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, nullptr);
+      _fds.erase(it);
+    } else {
+      update(fd, i, false);
+    }
+  }
+
+  static void take(std::vector<callback>& waiters,
+                   std::vector<callback>& batch)
+  {
+    for (auto& cb : waiters)
+      batch.push_back(std::move(cb));
+    waiters.clear();
+  }
+
+  int _epfd;
+  int _wake[2];
+  std::mutex _mutex;
+  std::unordered_map<int, interest> _fds;
+  std::vector<callback> _posted;
+  bool _stop;
+  std::thread _thread;
+
+  MARE_DELETE_METHOD(reactor(reactor const&));
+  MARE_DELETE_METHOD(reactor& operator=(reactor const&));
+};
+
+} //namespace internal
+
+} //namespace mare
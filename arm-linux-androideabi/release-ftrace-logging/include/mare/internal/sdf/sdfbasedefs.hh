@@ -24,6 +24,7 @@ namespace internal {
 
 class sdf_graph;
 class sdf_node;
+class sdf_replicated_node;
 
 class node_channels_accessor;
 
@@ -42,6 +43,11 @@ typedef internal::sdf_graph* sdf_graph_ptr;
 */
 typedef internal::sdf_node*  sdf_node_ptr;
 
+/**
+  Handle to a replicated SDF node
+*/
+typedef internal::sdf_replicated_node* sdf_replicated_node_ptr;
+
 } //namespace mare
 
 namespace mare {
@@ -0,0 +1,91 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file sdfprofile.hh */
+#pragma once
+
+#include <chrono>
+
+namespace mare {
+namespace internal {
+
+  /// sdf_node_profile:
+  /// measures the execution time of a node-function over a bounded number
+  /// of graph iterations, to derive an execution cost for the node.
+  ///
+  /// Mixed into sdf_node_typed, so that measurement is done in the
+  /// header-instantiated iter_work() and needs no support from the
+  /// partitions. A node executes in a single partition, so the counters are
+  /// only ever updated by one thread at a time.
+  ///
+  /// Only the node-function is timed: channel pops and pushes, which may
+  /// block on other partitions, are excluded.
+
+class sdf_node_profile {
+public:
+  typedef std::chrono::steady_clock clock;
+
+private:
+  /// Remaining graph iterations to be timed. Zero ==> not profiling.
+  std::size_t      _profile_iterations_left;
+
+  /// Graph iterations timed so far, and their accumulated execution time
+  std::size_t      _profiled_iterations;
+  clock::duration  _profiled_time;
+
+public:
+  sdf_node_profile() :
+    _profile_iterations_left(0),
+    _profiled_iterations(0),
+    _profiled_time(clock::duration::zero()) { }
+
+  /// Discards any previous measurement and times the next
+  /// num_iterations executions of the node-function.
+  void start_profile(std::size_t num_iterations)
+  {
+    _profile_iterations_left = num_iterations;
+    _profiled_iterations     = 0;
+    _profiled_time           = clock::duration::zero();
+  }
+
+  inline bool is_profiling() const
+  {
+    return _profile_iterations_left > 0;
+  }
+
+  inline void record(clock::duration elapsed)
+  {
+    _profile_iterations_left--;
+    _profiled_iterations++;
+    _profiled_time += elapsed;
+  }
+
+  std::size_t get_profiled_iterations() const
+  {
+    return _profiled_iterations;
+  }
+
+  /// Mean execution time of the node-function in microseconds,
+  /// or 0.0 if no graph iteration has been timed yet.
+  double get_measured_cost() const
+  {
+    if(_profiled_iterations == 0)
+      return 0.0;
+    return std::chrono::duration<double, std::micro>(_profiled_time).count() /
+           static_cast<double>(_profiled_iterations);
+  }
+};
+
+} //namespace internal
+} //namespace mare
@@ -0,0 +1,154 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file sdfreplacebody.hh */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
+#include <mare/exceptions.hh>
+#include <mare/internal/macros.hh>
+#include <mare/internal/sdf/sdfbasedefs.hh>
+#include <mare/internal/sdf/sdffusion.hh>
+
+namespace mare {
+namespace internal {
+
+  /// Replacement of Node Bodies
+  ///
+  /// A graph is elaborated and partitioned once, when it is launched, so
+  /// nodes and channels cannot be added to or removed from a launched graph.
+  /// The body of a node can however be replaced without disturbing the
+  /// graph: the node, its partition and the values buffered in its channels
+  /// stay as they are.
+  ///
+  /// The new body is staged by the application in the node's
+  /// sdf_node_body_replacement, and installed by the node itself right
+  /// before it next applies its body, so a body is never replaced while it
+  /// executes. A firing interrupted before applying the body (e.g., by a
+  /// pause while waiting on an input) applies the new body once resumed.
+  /// The node only checks an atomic flag on each firing, and locks
+  /// _pending_f_mutex only when a replacement is staged.
+  ///
+  /// FType is the node_fn_policy::ftype of the node.
+
+template<typename FType>
+class sdf_node_body_replacement {
+  std::atomic<bool> _has_pending_f;
+  std::mutex        _pending_f_mutex;
+  FType             _pending_f;
+
+public:
+  sdf_node_body_replacement() :
+    _has_pending_f(false),
+    _pending_f_mutex(),
+    _pending_f() { }
+
+  /// Invoked by the application. A body staged earlier that the node has
+  /// not installed yet is discarded.
+  void stage_replacement(FType const& f)
+  {
+    std::lock_guard<std::mutex> lock(_pending_f_mutex);
+    _pending_f = f;
+    _has_pending_f.store(true, std::memory_order_release);
+  }
+
+  /// Invoked by the node right before applying f
+  inline void install_replacement(FType& f)
+  {
+    if(!_has_pending_f.load(std::memory_order_acquire))
+      return;
+
+    std::lock_guard<std::mutex> lock(_pending_f_mutex);
+    f = _pending_f;
+    _pending_f = FType();
+    _has_pending_f.store(false, std::memory_order_relaxed);
+  }
+
+  MARE_DELETE_METHOD(sdf_node_body_replacement(
+                                    sdf_node_body_replacement const&));
+  MARE_DELETE_METHOD(sdf_node_body_replacement& operator=(
+                                    sdf_node_body_replacement const&));
+  MARE_DELETE_METHOD(sdf_node_body_replacement(sdf_node_body_replacement&&));
+  MARE_DELETE_METHOD(sdf_node_body_replacement& operator=(
+                                    sdf_node_body_replacement&&));
+};
+
+  /// Node-function types under which a body with parameters Params can
+  /// have been stored by the node policies (see sdfnodepolicy.hh)
+template<typename Params>
+struct sdf_node_fn_types;
+
+template<typename ...Ts>
+struct sdf_node_fn_types< std::tuple<Ts...> > {
+  typedef void (* func_pointer)(Ts&...);
+  typedef std::function<void(Ts&...)> std_function;
+};
+
+template<typename FnTypes, typename Body>
+void
+replace_func_pointer_body(sdf_node_ptr n, Body&& body, std::true_type)
+{
+  typedef typename FnTypes::func_pointer ftype;
+  auto r = dynamic_cast<sdf_node_body_replacement<ftype>*>(n);
+  MARE_API_ASSERT(r != nullptr,
+                  "body does not match the channels of the sdf node");
+  r->stage_replacement(static_cast<ftype>(body));
+}
+
+template<typename FnTypes, typename Body>
+void
+replace_func_pointer_body(sdf_node_ptr, Body&&, std::false_type)
+{
+  MARE_API_ASSERT(false,
+                  "body does not match the channels of the sdf node, or "
+                  "is not convertible to the function pointer the sdf node "
+                  "was created with");
+}
+
+} //namespace internal
+
+
+  /// See documentation in sdf.hh
+template<typename Body>
+void replace_sdf_node_body(sdf_node_ptr n, Body&& body)
+{
+  MARE_API_ASSERT(n != nullptr, "null sdf_node_ptr");
+
+  typedef typename std::decay<Body>::type body_type;
+  typedef internal::sdf_node_fn_types<
+            typename internal::sdf_body_traits<body_type>::param_types>
+          fn_types;
+
+  // Node created with a stateful body
+  auto r = dynamic_cast<internal::sdf_node_body_replacement<
+                          typename fn_types::std_function>*>(n);
+  if(r != nullptr) {
+    r->stage_replacement(
+         typename fn_types::std_function(std::forward<Body>(body)));
+    return;
+  }
+
+  // Node created with a function pointer
+  internal::replace_func_pointer_body<fn_types>(
+    n,
+    std::forward<Body>(body),
+    std::is_convertible<body_type, typename fn_types::func_pointer>());
+}
+
+} //namespace mare
@@ -0,0 +1,328 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file sdfreplicate.hh */
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <mare/internal/sdf/sdfapiimplementation.hh>
+
+namespace mare {
+
+  /// See sdf.hh
+void assign_cost(sdf_node_ptr n, double execution_cost);
+
+namespace internal {
+
+  /// Data-parallel Replication of Stateless Nodes
+  ///
+  /// A node executes its graph iterations in order, within a single
+  /// partition. A heavy node therefore bounds the throughput of the whole
+  /// graph to one core. If the node body is stateless (its outputs for a
+  /// graph iteration depend only on its inputs for that iteration), the
+  /// node can instead be replicated, with replica r performing the work of
+  /// the graph iterations i where (i % num_replicas) == r:
+  ///
+  ///                    |-> (tr0) -> replica0 -> (fr0) -|
+  ///  ins -> splitter --|-> (tr1) -> replica1 -> (fr1) -|-> joiner -> outs
+  ///                    |-> ...                         |
+  ///
+  ///  - splitter: pops the original inputs, and on graph iteration i pushes
+  ///    a valid replica_token carrying the inputs to replica (i %
+  ///    num_replicas), and an invalid (empty) token to every other replica.
+  ///  - replica:  applies the user body to a valid token, and forwards an
+  ///    invalid token untouched.
+  ///  - joiner:   on graph iteration i pops the token from replica (i %
+  ///    num_replicas) and pushes its outputs to the original outputs.
+  ///    Outputs are therefore produced in graph iteration order.
+  ///
+  /// The graph iteration is supplied to the splitter and the joiner by a
+  /// separate counter node, which keeps it in a channel looping back to
+  /// itself, preloaded with iteration 0. Splitter and joiner therefore only
+  /// have ordinary in- and out-channels.
+  ///
+  /// Each replica only fires cheaply on the iterations it skips, so once
+  /// the replicas are placed in different partitions, consecutive graph
+  /// iterations of the original node execute concurrently. Since the
+  /// SDF runtime only sees ordinary nodes and channels, pause, resume and
+  /// cancel retain their semantics.
+
+  /// A token carries the values of all the parameters of the user body:
+  /// the inputs are filled by the splitter, the outputs by the replica.
+template<typename Values>
+struct replica_token {
+  bool   _valid;
+  Values _value;
+
+  replica_token() :
+    _valid(false),
+    _value() { }
+};
+
+  /// Body of each replica. Stateless user bodies are copied into each
+  /// replica.
+template<typename Body, typename Values>
+class replica_body {
+  Body _body;
+
+public:
+  explicit replica_body(Body const& body) :
+    _body(body) { }
+
+  void operator()(replica_token<Values>& in, replica_token<Values>& out)
+  {
+    out._valid = in._valid;
+    if(in._valid) {
+      out._value = in._value;
+      apply(_body, out._value);
+    }
+  }
+};
+
+  /// Programmatic bodies of the splitter and the joiner.
+  ///
+  /// Channel layout of the splitter:
+  ///   [0, num_ins)                    original inputs
+  ///   num_ins                         iteration
+  ///   [num_ins+1, num_ins+1+replicas) tokens to the replicas
+  ///
+  /// Channel layout of the joiner:
+  ///   [0, replicas)                   tokens from the replicas
+  ///   replicas                        iteration
+  ///   [replicas+1, replicas+1+outs)   original outputs
+template<std::size_t num_ins, typename Values>
+class sdf_replication {
+  typedef replica_token<Values> token;
+
+  static std::size_t const num_outs = std::tuple_size<Values>::value - num_ins;
+
+  template<std::size_t index>
+  static typename std::enable_if<(index == 0), void>::type
+  read_inputs(node_channels&, Values&) { }
+
+  template<std::size_t index>
+  static typename std::enable_if<(index > 0), void>::type
+  read_inputs(node_channels& ncs, Values& values)
+  {
+    ncs.read(std::get<index-1>(values), index-1);
+    read_inputs<index-1>(ncs, values);
+  }
+
+  template<std::size_t index>
+  static typename std::enable_if<(index == 0), void>::type
+  write_outputs(node_channels&, Values const&, std::size_t) { }
+
+  template<std::size_t index>
+  static typename std::enable_if<(index > 0), void>::type
+  write_outputs(node_channels& ncs, Values const& values, std::size_t first)
+  {
+    ncs.write(std::get<num_ins+index-1>(values), first+index-1);
+    write_outputs<index-1>(ncs, values, first);
+  }
+
+public:
+  static void count(std::size_t& iteration,
+                    std::size_t& next_iteration,
+                    std::size_t& split_iteration,
+                    std::size_t& join_iteration)
+  {
+    next_iteration  = iteration + 1;
+    split_iteration = iteration;
+    join_iteration  = iteration;
+  }
+
+  static void split(node_channels& ncs)
+  {
+    std::size_t const num_replicas = ncs.get_num_channels() - num_ins - 1;
+
+    std::size_t iteration;
+    ncs.read(iteration, num_ins);
+
+    token t;
+    t._valid = true;
+    read_inputs<num_ins>(ncs, t._value);
+
+    token const skip;
+    std::size_t const r = iteration % num_replicas;
+    for(std::size_t i=0; i<num_replicas; i++)
+      ncs.write(i == r ? t : skip, num_ins+1+i);
+  }
+
+  static void join(node_channels& ncs)
+  {
+    std::size_t const num_replicas = ncs.get_num_channels() - num_outs - 1;
+
+    std::size_t iteration;
+    ncs.read(iteration, num_replicas);
+
+    token t;
+    ncs.read(t, iteration % num_replicas);
+    MARE_INTERNAL_ASSERT(t._valid,
+                         "replica for iteration %lld produced no token",
+                         static_cast<long long int>(iteration));
+    write_outputs<num_outs>(ncs, t._value, num_replicas+1);
+  }
+};
+
+  /// Converts a tuple of data_channel pointers into channel-direction
+  /// bindings for the programmatic splitter and joiner.
+template<std::size_t index, typename ...Ts>
+typename std::enable_if<(index == sizeof...(Ts)), void>::type
+append_dir_channels(
+  std::vector<tuple_dir_channel>&,
+  std::tuple< data_channel<Ts>*... > const&,
+  direction)
+{ }
+
+template<std::size_t index, typename ...Ts>
+typename std::enable_if<(index < sizeof...(Ts)), void>::type
+append_dir_channels(
+  std::vector<tuple_dir_channel>&            v_dir_channels,
+  std::tuple< data_channel<Ts>*... > const& pdc_tuple,
+  direction                                  dir)
+{
+  v_dir_channels.push_back(
+    std::make_tuple(dir, static_cast<channel*>(std::get<index>(pdc_tuple))));
+  append_dir_channels<index+1, Ts...>(v_dir_channels, pdc_tuple, dir);
+}
+
+  /// sdf_replicated_node:
+  /// owns the channels internal to a replicated node, and retains the
+  /// handles to the nodes it was expanded into.
+class sdf_replicated_node {
+  std::vector< std::shared_ptr<void> > _channels;
+
+public:
+  sdf_node_ptr              _counter;
+  sdf_node_ptr              _splitter;
+  std::vector<sdf_node_ptr> _replicas;
+  sdf_node_ptr              _joiner;
+
+  sdf_replicated_node() :
+    _channels(),
+    _counter(nullptr),
+    _splitter(nullptr),
+    _replicas(),
+    _joiner(nullptr) { }
+
+  template<typename T>
+  data_channel<T>* create_channel()
+  {
+    auto dc = std::make_shared< data_channel<T> >();
+    _channels.push_back(dc);
+    return dc.get();
+  }
+
+  MARE_DELETE_METHOD(sdf_replicated_node(sdf_replicated_node const&));
+  MARE_DELETE_METHOD(sdf_replicated_node& operator=(
+                                              sdf_replicated_node const&));
+  MARE_DELETE_METHOD(sdf_replicated_node(sdf_replicated_node&&));
+  MARE_DELETE_METHOD(sdf_replicated_node& operator=(sdf_replicated_node&&));
+};
+
+} //namespace internal
+
+  /// See documentation in sdf.hh
+template<typename Body, typename ...Ins, typename ...Outs>
+sdf_replicated_node_ptr create_replicated_sdf_node(
+  sdf_graph_ptr                 g,
+  std::size_t                   num_replicas,
+  Body&&                        body,
+  io_channels<Ins...> const&    inputs,
+  io_channels<Outs...> const&   outputs)
+{
+  MARE_API_ASSERT(num_replicas > 0, "num_replicas must be > 0");
+  MARE_API_ASSERT(inputs._dir == internal::direction::in,
+                  "first channel group must be created with with_inputs()");
+  MARE_API_ASSERT(outputs._dir == internal::direction::out,
+                  "second channel group must be created with with_outputs()");
+
+  typedef std::tuple<Ins..., Outs...>           values;
+  typedef internal::replica_token<values>        token;
+  typedef internal::sdf_replication<sizeof...(Ins), values> replication;
+  typedef internal::replica_body<typename std::decay<Body>::type, values>
+          rbody;
+
+  auto rn = new internal::sdf_replicated_node();
+
+  auto iteration       = rn->create_channel<std::size_t>();
+  auto split_iteration = rn->create_channel<std::size_t>();
+  auto join_iteration  = rn->create_channel<std::size_t>();
+  preload_channel(*iteration, std::vector<std::size_t>(1, 0));
+  rn->_counter = create_sdf_node(g,
+                                 &replication::count,
+                                 with_inputs (*iteration),
+                                 with_outputs(*iteration,
+                                              *split_iteration,
+                                              *join_iteration));
+
+  std::vector<tuple_dir_channel> split_channels;
+  internal::append_dir_channels<0>(split_channels, inputs._tpdcs,
+                                   internal::direction::in);
+  split_channels.push_back(as_in_channel_tuple(*split_iteration));
+
+  std::vector<tuple_dir_channel> join_channels;
+
+  for(std::size_t r=0; r<num_replicas; r++) {
+    auto to_replica   = rn->create_channel<token>();
+    auto from_replica = rn->create_channel<token>();
+    split_channels.push_back(as_out_channel_tuple(*to_replica));
+    join_channels .push_back(as_in_channel_tuple (*from_replica));
+
+    rn->_replicas.push_back(create_sdf_node(g,
+                                            rbody(body),
+                                            with_inputs (*to_replica),
+                                            with_outputs(*from_replica)));
+  }
+
+  join_channels.push_back(as_in_channel_tuple(*join_iteration));
+  internal::append_dir_channels<0>(join_channels, outputs._tpdcs,
+                                   internal::direction::out);
+
+  rn->_splitter = create_sdf_node(g, &replication::split, split_channels);
+  rn->_joiner   = create_sdf_node(g, &replication::join,  join_channels);
+
+  return rn;
+}
+
+  /// See documentation in sdf.hh
+inline
+void assign_cost(sdf_replicated_node_ptr rn, double execution_cost)
+{
+  MARE_API_ASSERT(rn != nullptr, "null sdf_replicated_node_ptr");
+  for(auto n : rn->_replicas)
+    assign_cost(n, execution_cost / double(rn->_replicas.size()));
+}
+
+  /// See documentation in sdf.hh
+inline
+std::vector<sdf_node_ptr> const&
+get_replicas(sdf_replicated_node_ptr rn)
+{
+  MARE_API_ASSERT(rn != nullptr, "null sdf_replicated_node_ptr");
+  return rn->_replicas;
+}
+
+  /// See documentation in sdf.hh
+inline
+void destroy_replicated_sdf_node(sdf_replicated_node_ptr& rn)
+{
+  delete rn;
+  rn = nullptr;
+}
+
+} //namespace mare
@@ -210,6 +210,212 @@ public:
   void unlock();
 };
 
+/// Exponential backoff for spin loops: each call to pause() spins twice
+/// as long as the previous one, up to MAX_SPINS iterations.
+class spin_backoff {
+private:
+  size_t _spins;
+
+public:
+  static const size_t MAX_SPINS = 64;
+
+  spin_backoff() : _spins(1) {}
+
+  void pause() {
+    for (size_t i = 0; i < _spins; ++i) {
+#if defined(__i386__) || defined(__x86_64__)
+      __asm__ __volatile__("pause" ::: "memory");
+#elif defined(__ARM_ARCH_7A__) || defined(__aarch64__)
+      __asm__ __volatile__("yield" ::: "memory");
+#else
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+    if (_spins < MAX_SPINS)
+      _spins *= 2;
+  }
+
+  bool saturated() const { return _spins >= MAX_SPINS; }
+};
+
+/// Mutex for locks under heavy contention.
+///
+/// With mare::mutex, every waiter polls the lock word, so under contention
+/// each release triggers a storm of reads and failed CASes on one cache
+/// line. queued_mutex instead lets tasks that find the lock held line up
+/// in an MCS queue (J. M. Mellor-Crummey and M. L. Scott, 1991), like the
+/// Linux qspinlock: only the waiter at the head of the queue polls
+/// _locked, with exponential backoff; everybody else waits on the _state
+/// of its own waiter object, which lives on its stack. When the head
+/// acquires the lock, it hands the head position to its successor.
+///
+/// A task first polls the lock for a short while (as the qspinlock
+/// "pending" bit does) and only queues up if that fails. The lock itself
+/// is not handed over; an unlock() simply clears _locked, and a task that
+/// arrives at that moment may take it. Handing over the lock would make
+/// every release wait until the next waiter runs again, which with more
+/// waiters than cores costs a context switch per acquisition.
+///
+/// Waiters first spin, then yield to the MARE scheduler, and finally
+/// block on a futex, as mare::mutex does. The head blocks on _futex and
+/// is woken by the first unlock() after it went to sleep; the other
+/// waiters block on a futex of their own and are woken by their
+/// predecessor.
+class queued_mutex {
+private:
+  enum { WAITING, SLEEPING, GRANTED };
+
+  struct waiter {
+    std::atomic<waiter*> _next;
+    std::atomic<int> _state;
+    // Set by the predecessor once it has woken up a sleeping waiter and
+    // will not access it anymore
+    std::atomic<bool> _released;
+    futex* _futex;
+
+    waiter() : _next(nullptr), _state(WAITING), _released(false),
+               _futex(nullptr) {}
+
+    MARE_DELETE_METHOD(waiter(waiter const&));
+    MARE_DELETE_METHOD(waiter& operator=(waiter const&));
+  };
+
+  std::atomic<int> _locked;
+  std::atomic<waiter*> _tail;
+  // 1 if the head of the queue may be blocked on _futex. The head waits
+  // on this word rather than on _locked: futex::wakeup() does nothing
+  // if the head has not called wait() yet, so the head must notice that
+  // an unlock() has cleared it even if _locked is set again by then.
+  std::atomic<int> _head_sleeping;
+  futex _futex;
+
+public:
+  static const int YIELD_THRESHOLD = 10;
+
+  queued_mutex() :
+    _locked(0),
+    _tail(nullptr),
+    _head_sleeping(0),
+    _futex() {}
+
+  MARE_DELETE_METHOD(queued_mutex(queued_mutex&));
+  MARE_DELETE_METHOD(queued_mutex(queued_mutex&&));
+  MARE_DELETE_METHOD(queued_mutex& operator=(queued_mutex const&));
+  MARE_DELETE_METHOD(queued_mutex& operator=(queued_mutex&&));
+
+  void lock() {
+    if (try_lock())
+      return;
+    lock_slow();
+  }
+
+  bool try_lock() {
+    int expected = 0;
+    return _locked.load(std::memory_order_relaxed) == 0 &&
+      _locked.compare_exchange_strong(expected, 1);
+  }
+
+  void unlock() {
+    // seq_cst, for the handshake with acquire_as_head()
+    _locked.store(0);
+    if (_head_sleeping.load() == 1 &&
+        _head_sleeping.exchange(0) == 1)
+      _futex.wakeup(1);
+  }
+
+private:
+  void lock_slow() {
+    // Poll the lock for a little while before joining the queue; most
+    // critical sections are short enough for this to succeed
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      backoff.pause();
+      if (try_lock())
+        return;
+    }
+
+    waiter me;
+    waiter* prev = _tail.exchange(&me);
+    if (prev != nullptr) {
+      prev->_next.store(&me);
+      wait_for_head(me);
+    }
+
+    acquire_as_head();
+
+    // Hand the head position to our successor, if any
+    waiter* succ = me._next.load();
+    if (succ == nullptr) {
+      waiter* expected = &me;
+      if (_tail.compare_exchange_strong(expected, nullptr))
+        return;
+      // A waiter has swung _tail, but not linked itself in yet
+      backoff = spin_backoff();
+      while ((succ = me._next.load()) == nullptr)
+        backoff.pause();
+    }
+    grant(succ);
+  }
+
+  void acquire_as_head() {
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      if (try_lock())
+        return;
+      backoff.pause();
+    }
+    for (int i = 0; i < YIELD_THRESHOLD; ++i) {
+      if (try_lock())
+        return;
+      yield();
+    }
+    // We store _head_sleeping and then load _locked, while unlock()
+    // stores _locked and then loads _head_sleeping, all seq_cst: either
+    // we see _locked cleared, or unlock() sees us sleeping and wakes us.
+    for (;;) {
+      _head_sleeping.store(1);
+      int expected = 0;
+      if (_locked.load() == 0 &&
+          _locked.compare_exchange_strong(expected, 1))
+        break;
+      _futex.wait(&_head_sleeping, 1);
+    }
+    _head_sleeping.store(0);
+  }
+
+  static void wait_for_head(waiter& me) {
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      if (me._state.load() == GRANTED)
+        return;
+      backoff.pause();
+    }
+    for (int i = 0; i < YIELD_THRESHOLD; ++i) {
+      if (me._state.load() == GRANTED)
+        return;
+      yield();
+    }
+
+    futex f;
+    me._futex = &f;
+    int expected = WAITING;
+    if (!me._state.compare_exchange_strong(expected, SLEEPING))
+      return;
+    while (me._state.load() != GRANTED)
+      f.wait(&me._state, SLEEPING);
+    // The predecessor may still be inside f.wakeup()
+    while (!me._released.load())
+      backoff.pause();
+  }
+
+  static void grant(waiter* succ) {
+    if (succ->_state.exchange(GRANTED) == SLEEPING) {
+      succ->_futex->wakeup(1);
+      succ->_released.store(true);
+    }
+  }
+};
+
 /// Adds an id and number of permits (for that id) to
 /// allow a task/thread to call lock and unlock multiple times
 template<class Lock>
@@ -302,45 +508,23 @@ public:
     return _lock.try_lock();
   }
 
+  void unlock()
+  {
+    _lock.unlock();
+  }
+
   template<class Rep, class Period>
   bool try_lock_for( const std::chrono::duration<Rep,Period>& timeout_duration)
   {
-    auto end_time = std::chrono::high_resolution_clock::now() +
-      timeout_duration;
-    size_t local_spins = 0;
-
-    while(_lock.try_lock() == false){
-      if(end_time >= std::chrono::high_resolution_clock::now()){
-        return false;
-      }
-
-      if(local_spins > SPIN_THRESHOLD){
-        yield();
-        local_spins = 0;
-      }
-    }
-
-    return true;
+    return try_lock_until(std::chrono::steady_clock::now() +
+                          timeout_duration);
   }
 
   template<class Clock, class Duration>
   bool try_lock_until(const std::chrono::
                       time_point<Clock,Duration>& timeout_time)
   {
-    size_t local_spins = 0;
-
-    while(_lock.try_lock() == false){
-      if(timeout_time >= std::chrono::high_resolution_clock::now()){
-        return false;
-      }
-
-      if(local_spins > SPIN_THRESHOLD){
-        yield();
-        local_spins = 0;
-      }
-    }
-
-    return true;
+    return poll_until([this] { return _lock.try_lock(); }, timeout_time);
   }
 };
 
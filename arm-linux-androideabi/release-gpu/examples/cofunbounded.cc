@@ -0,0 +1,219 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/cofqueue.hh>
+#include <mare/cofunboundedqueue.hh>
+#include <mare/cofunboundedstack.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::cof_unbounded_queue and
+//     mare::cof_unbounded_stack for element types that do not fit in a
+//     size_t, including move-only types,
+//  2. show that the unbounded containers grow instead of failing a push,
+//     and
+//  3. compare their throughput against mare::cof_queue<size_t>, with and
+//     without the batch operations try_push_n()/try_pop_n().
+//
+//  Each benchmark launches num_tasks tasks. Every task repeatedly pushes
+//  a round of elements and then pops as many elements as it pushed, so
+//  the containers never run empty while a task is still popping.
+//  cof_queue is sized to hold all the elements; the unbounded containers
+//  start out small and have to grow.
+
+const std::size_t num_tasks    = 8;
+const std::size_t num_rounds   = 256;
+const std::size_t round_size   = 512;
+const std::size_t num_elements = num_tasks * num_rounds * round_size;
+
+// Element that does not fit into a size_t
+typedef std::array<std::size_t, 4> wide_element;
+
+template<typename Body>
+double
+run_tasks(Body&& body)
+{
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_tasks; t++)
+    mare::launch(g, [t, &body] { body(t); });
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_elements) / seconds;
+}
+
+// Pushes and pops one element at a time
+template<typename Container, typename MakeElement, typename ElementValue>
+double
+run_single(Container& c, MakeElement make, ElementValue value)
+{
+  std::atomic<std::size_t> sum(0);
+  double throughput = run_tasks([&](std::size_t t) {
+      std::size_t local_sum = 0;
+      for (std::size_t r = 0; r < num_rounds; r++) {
+        std::size_t base = (t * num_rounds + r) * round_size;
+        for (std::size_t i = 0; i < round_size; i++) {
+          bool pushed = c.push(make(base + i));
+          assert(pushed);
+          MARE_UNUSED(pushed);
+        }
+        for (std::size_t i = 0; i < round_size; i++) {
+          typename Container::value_type e;
+          while (!c.pop(e)) { }
+          local_sum += value(e);
+        }
+      }
+      sum += local_sum;
+    });
+
+  std::size_t n = num_elements;
+  assert(sum == n * (n - 1) / 2);
+  MARE_UNUSED(n);
+  return throughput;
+}
+
+// Pushes and pops a round of elements at a time
+template<typename Container, typename MakeElement, typename ElementValue>
+double
+run_batched(Container& c, MakeElement make, ElementValue value)
+{
+  typedef typename Container::value_type element;
+
+  std::atomic<std::size_t> sum(0);
+  double throughput = run_tasks([&](std::size_t t) {
+      std::size_t local_sum = 0;
+      std::vector<element> round(round_size);
+      for (std::size_t r = 0; r < num_rounds; r++) {
+        std::size_t base = (t * num_rounds + r) * round_size;
+        for (std::size_t i = 0; i < round_size; i++)
+          round[i] = make(base + i);
+        c.try_push_n(std::make_move_iterator(round.begin()), round_size);
+        for (std::size_t popped = 0; popped < round_size; )
+          popped += c.try_pop_n(round.begin() + popped, round_size - popped);
+        for (auto& e : round)
+          local_sum += value(e);
+      }
+      sum += local_sum;
+    });
+
+  std::size_t n = num_elements;
+  assert(sum == n * (n - 1) / 2);
+  MARE_UNUSED(n);
+  return throughput;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  auto make_size_t  = [](std::size_t i) { return i; };
+  auto value_size_t = [](std::size_t e) { return e; };
+
+  auto make_wide  = [](std::size_t i) { return wide_element{{i, i, i, i}}; };
+  auto value_wide = [](wide_element const& e) {
+    assert(e[0] == e[3]);
+    return e[0];
+  };
+
+  auto make_unique  = [](std::size_t i) {
+    return std::unique_ptr<std::size_t>(new std::size_t(i));
+  };
+  auto value_unique = [](std::unique_ptr<std::size_t> const& e) {
+    return *e;
+  };
+
+  double baseline;
+  {
+    mare::cof_queue<std::size_t> q(num_elements);
+    baseline = run_single(q, make_size_t, value_size_t);
+    MARE_LLOG("cof_queue<size_t>                      %12.1f elements/s",
+              baseline);
+  }
+
+  {
+    mare::cof_unbounded_queue<std::size_t> q(64);
+    double throughput = run_single(q, make_size_t, value_size_t);
+    MARE_LLOG("cof_unbounded_queue<size_t>            %12.1f elements/s "
+              "(%.2fx)", throughput, throughput / baseline);
+  }
+
+  {
+    mare::cof_unbounded_queue<std::size_t> q(64);
+    double throughput = run_batched(q, make_size_t, value_size_t);
+    MARE_LLOG("cof_unbounded_queue<size_t>, batched   %12.1f elements/s "
+              "(%.2fx)", throughput, throughput / baseline);
+  }
+
+  {
+    mare::cof_unbounded_queue<wide_element> q(64);
+    double throughput = run_batched(q, make_wide, value_wide);
+    MARE_LLOG("cof_unbounded_queue<wide>, batched     %12.1f elements/s "
+              "(%.2fx)", throughput, throughput / baseline);
+  }
+
+  {
+    mare::cof_unbounded_queue<std::unique_ptr<std::size_t>> q(64);
+    double throughput = run_batched(q, make_unique, value_unique);
+    MARE_LLOG("cof_unbounded_queue<unique_ptr>, batched %10.1f elements/s "
+              "(%.2fx)", throughput, throughput / baseline);
+  }
+
+  {
+    mare::cof_unbounded_stack<wide_element> s(64);
+    double throughput = run_batched(s, make_wide, value_wide);
+    MARE_LLOG("cof_unbounded_stack<wide>, batched     %12.1f elements/s "
+              "(%.2fx)", throughput, throughput / baseline);
+  }
+
+  // Sequential order is preserved across the growth of the containers
+  {
+    mare::cof_unbounded_queue<wide_element> q(4);
+    mare::cof_unbounded_stack<wide_element> s(4);
+    for (std::size_t i = 0; i < 1000; i++) {
+      q.push(make_wide(i));
+      s.push(make_wide(i));
+    }
+    for (std::size_t i = 0; i < 1000; i++) {
+      wide_element e;
+      bool popped = q.pop(e);
+      assert(popped && e[0] == i);
+      popped = s.pop(e);
+      assert(popped && e[0] == 999 - i);
+      MARE_UNUSED(popped);
+    }
+    wide_element e;
+    assert(!q.pop(e) && !s.pop(e));
+    MARE_UNUSED(e);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
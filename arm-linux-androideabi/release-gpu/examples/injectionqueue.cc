@@ -0,0 +1,141 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/internal/injectionqueue.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of the internal injection_queue to hand work
+//     from threads outside of MARE (e.g., I/O threads) to consumers that
+//     drain it in batches, and
+//  2. compare its throughput against a std::deque protected by a
+//     std::mutex, from which consumers pop one element at a time, as
+//     MARE workers do with the foreign task queue.
+//
+//  Each benchmark runs num_threads producer threads and as many consumer
+//  threads. Producers push num_elements elements in total; consumers pop
+//  until all of them have been consumed.
+
+const std::size_t num_elements = 1 << 21;
+const std::size_t batch_size   = 32;
+
+class locked_deque {
+public:
+  locked_deque() : _mutex(), _deque() {}
+
+  void push(std::size_t v) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _deque.push_back(v);
+  }
+
+  bool try_pop(std::size_t& v) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_deque.empty())
+      return false;
+    v = _deque.front();
+    _deque.pop_front();
+    return true;
+  }
+
+private:
+  std::mutex _mutex;
+  std::deque<std::size_t> _deque;
+};
+
+typedef mare::internal::injection_queue<std::size_t> injection_queue;
+
+// Runs producers and consumers; pop(c) pops elements as consumer c and
+// returns how many it popped. Returns the throughput, in elements/s.
+template<typename Push, typename Pop>
+double
+run(std::size_t num_threads, Push push, Pop pop)
+{
+  std::atomic<std::size_t> consumed(0);
+  std::size_t per_thread = num_elements / num_threads;
+
+  std::vector<std::thread> threads;
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&push, t, per_thread] {
+          for (std::size_t i = 0; i < per_thread; i++)
+            push(t, i);
+        }));
+    threads.push_back(std::thread([&pop, &consumed, t, per_thread,
+                                   num_threads] {
+          std::size_t total = per_thread * num_threads;
+          while (consumed.load() < total) {
+            std::size_t n = pop(t);
+            if (n == 0)
+              std::this_thread::yield();
+            else
+              consumed.fetch_add(n);
+          }
+        }));
+  }
+  for (auto& t : threads)
+    t.join();
+  auto end = std::chrono::system_clock::now();
+
+  assert(consumed.load() == per_thread * num_threads);
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(per_thread * num_threads) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("threads    locked_deque  injection_queue");
+  for (std::size_t num_threads = 1; num_threads <= 4; num_threads *= 2) {
+    locked_deque ld;
+    double locked = run(num_threads,
+                        [&ld] (std::size_t, std::size_t v) { ld.push(v); },
+                        [&ld] (std::size_t) -> std::size_t {
+                          std::size_t v;
+                          return ld.try_pop(v) ? 1 : 0;
+                        });
+
+    // Producer t pushes to shard t, consumer c drains shard c
+    injection_queue iq(num_threads);
+    double injected = run(num_threads,
+                          [&iq] (std::size_t t, std::size_t v) {
+                            iq.push(v, t);
+                          },
+                          [&iq] (std::size_t c) -> std::size_t {
+                            std::size_t batch[batch_size];
+                            return iq.try_pop_n(c, batch, batch_size);
+                          });
+
+    MARE_LLOG("%-7zu %14.1f %16.1f elements/s (%.2fx)",
+              num_threads, locked, injected, injected / locked);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/sdf.hh>
+
+///////////////
+//
+//  Pipeline
+//     source -> (dc1) -> light -> (dc2) -> heavy -> (dc3) -> sink
+//
+//  Goal is to
+//  1. illustrate the use of mare::profile_cost() and
+//     mare::get_measured_cost() to measure node costs, instead of
+//     estimating them by hand for mare::assign_cost(), and
+//  2. compare the throughput of the pipeline partitioned with the default
+//     costs against the pipeline partitioned with the measured costs.
+//
+//  heavy is about a hundred times more expensive than light. A first
+//  graph is launched for a few iterations with profiling enabled on all
+//  its nodes. Since a graph is partitioned only once, when it is launched,
+//  the measured costs are then assigned to the nodes of a second graph of
+//  the same shape, which performs the actual computation.
+//
+//  Please first see examples/sdfbasicpipe.cc for the basic mechanisms
+//  to construct a graph and execute it, and examples/sdfassigncost.cc
+//  for the use of node costs in partitioning.
+
+const std::size_t num_profile_iterations = 100;
+const std::size_t num_iterations = 2000;
+
+const std::size_t num_nodes = 4;
+const char* node_names[num_nodes] = { "source", "light", "heavy", "sink" };
+
+void work(double& x, int n)
+{
+  for(int i=0; i<n; i++)
+    x = std::sqrt(x + i);
+}
+
+// Creates the pipeline in g, returning its nodes in pipeline order
+std::array<mare::sdf_node_ptr, num_nodes>
+create_pipeline(mare::sdf_graph_ptr         g,
+                mare::data_channel<double>& dc1,
+                mare::data_channel<double>& dc2,
+                mare::data_channel<double>& dc3,
+                double&                     sum)
+{
+  std::array<mare::sdf_node_ptr, num_nodes> nodes;
+
+  nodes[0] = mare::create_sdf_node(g,
+                                   [](double& out)
+                                   {
+                                     out = 1.0;
+                                   },
+                                   mare::with_outputs(dc1));
+
+  nodes[1] = mare::create_sdf_node(g,
+                                   [](double& in, double& out)
+                                   {
+                                     out = in;
+                                     work(out, 100);
+                                   },
+                                   mare::with_inputs(dc1),
+                                   mare::with_outputs(dc2));
+
+  nodes[2] = mare::create_sdf_node(g,
+                                   [](double& in, double& out)
+                                   {
+                                     out = in;
+                                     work(out, 10000);
+                                   },
+                                   mare::with_inputs(dc2),
+                                   mare::with_outputs(dc3));
+
+  nodes[3] = mare::create_sdf_node(g,
+                                   [&sum](double& in)
+                                   {
+                                     sum += in;
+                                   },
+                                   mare::with_inputs(dc3));
+  return nodes;
+}
+
+// Returns the throughput of the pipeline, in iterations/s.
+// Nodes are assigned the given costs, unless costs is null.
+double
+run_pipeline(double const* costs, double& sum)
+{
+  mare::data_channel<double> dc1, dc2, dc3;
+  mare::sdf_graph_ptr g = mare::create_sdf_graph();
+
+  sum = 0.0;
+  auto nodes = create_pipeline(g, dc1, dc2, dc3, sum);
+  if(costs != nullptr) {
+    for(std::size_t i=0; i<num_nodes; i++)
+      mare::assign_cost(nodes[i], costs[i]);
+  }
+
+  auto start = std::chrono::system_clock::now();
+  mare::launch_and_wait(g, num_iterations);
+  auto end = std::chrono::system_clock::now();
+
+  mare::destroy_sdf_graph(g);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_iterations) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  // Profile the nodes of a short-lived graph
+  double costs[num_nodes];
+  {
+    mare::data_channel<double> dc1, dc2, dc3;
+    mare::sdf_graph_ptr g = mare::create_sdf_graph();
+
+    double sum = 0.0;
+    auto nodes = create_pipeline(g, dc1, dc2, dc3, sum);
+    for(auto n : nodes)
+      mare::profile_cost(n, num_profile_iterations);
+
+    mare::launch_and_wait(g, num_profile_iterations);
+
+    for(std::size_t i=0; i<num_nodes; i++) {
+      costs[i] = mare::get_measured_cost(nodes[i]);
+      MARE_LLOG("measured cost of %-6s: %10.3f us", node_names[i], costs[i]);
+    }
+    assert(costs[2] > costs[1]);
+
+    mare::destroy_sdf_graph(g);
+  }
+
+  double default_sum, measured_sum;
+  double default_throughput  = run_pipeline(nullptr, default_sum);
+  double measured_throughput = run_pipeline(costs, measured_sum);
+
+  MARE_LLOG("default costs:  %10.1f iterations/s", default_throughput);
+  MARE_LLOG("measured costs: %10.1f iterations/s (%.2fx)",
+            measured_throughput, measured_throughput / default_throughput);
+
+  assert(default_sum == measured_sum);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mare/mare.h>
+#include <mare/timer.hh>
+
+using namespace std;
+
+///////////////
+//
+//  Goal is to
+//  1. run a periodic heartbeat with mare::launch_every(period, body),
+//  2. launch a delayed flush with mare::launch_after(group, delay, body),
+//     without tying up a worker thread while it waits, and
+//  3. stop both through their groups.
+
+atomic<size_t> heartbeats;
+atomic<size_t> flushes;
+
+int main() {
+
+  // Initialize the MARE runtime.
+  mare::runtime::init();
+
+  // Beat every 5 milliseconds until the returned group is canceled.
+  auto heartbeat = mare::launch_every(chrono::milliseconds(5), [] {
+      heartbeats++;
+    });
+
+  // Flush once after 20 milliseconds. wait_for covers the delayed task,
+  // because it joins the group before it is launched.
+  auto flush = mare::create_group();
+  mare::launch_after(flush, chrono::milliseconds(20), [] {
+      flushes++;
+    });
+  mare::wait_for(flush);
+  MARE_ALOG("flushed once after %zu heartbeats", heartbeats.load());
+
+  // A delayed task in a canceled group never runs.
+  auto retry = mare::create_group();
+  mare::launch_after(retry, chrono::seconds(10), [] {
+      flushes++;
+    });
+  mare::cancel(retry);
+  mare::wait_for(retry);
+
+  mare::cancel(heartbeat);
+  mare::wait_for(heartbeat);
+  MARE_ALOG("%zu flushes, %zu heartbeats", flushes.load(), heartbeats.load());
+
+  // Shutdown the MARE runtime.
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file coroutine.hh */
+#pragma once
+
+// Requires C++20 coroutines, e.g., -std=c++20 with GCC 11 or later.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define MARE_HAVE_COROUTINES 1
+#endif
+
+#ifdef MARE_HAVE_COROUTINES
+
+#include <utility>
+
+#include <mare/attr.hh>
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/coroutine.hh>
+
+namespace mare
+{
+
+/** @addtogroup execution
+@{ */
+/**
+    Coroutine that runs on MARE workers.
+
+    A function that returns <tt>mare::coro_task<T></tt> and uses
+    <tt>co_await</tt> or <tt>co_return</tt> is a coroutine. It does
+    not start when it is called. It starts when another coroutine
+    awaits it with <tt>co_await</tt>, which returns the
+    <tt>T</tt> passed to <tt>co_return</tt>, or when it is launched
+    with launch().
+
+    Inside the coroutine, <tt>co_await</tt> accepts:
+    - a mare::task_ptr or mare::unsafe_task_ptr: resumes once the
+      task has completed or has been canceled;
+    - a mare::group_ptr: resumes once the group is empty;
+    - mare::lock_async(m): resumes once the coroutine holds mutex
+      <tt>m</tt>;
+    - another <tt>mare::coro_task</tt>.
+
+    None of them blocks the worker: the coroutine is suspended, and a
+    MARE task resumes it later, possibly on another worker. Awaiting a
+    task chains the resumption to the task's completion. Groups and
+    mutexes have no completion to chain to, so they are polled from
+    yielding tasks.
+
+    Coroutine frames are allocated from per-thread pools.
+
+    @par Example
+    @includelineno examples/coroutines.cc
+*/
+template<typename T = void>
+class coro_task {
+public:
+  class promise_type : public internal::coro_promise<T> {
+  public:
+    coro_task get_return_object()
+    {
+      return coro_task(handle::from_promise(*this));
+    }
+  };
+
+  coro_task(coro_task&& other) noexcept :
+    _h(std::exchange(other._h, nullptr)) { }
+
+  coro_task& operator=(coro_task&& other) noexcept
+  {
+    if (this != &other) {
+      if (_h)
+        _h.destroy();
+      _h = std::exchange(other._h, nullptr);
+    }
+    return *this;
+  }
+
+  ~coro_task()
+  {
+    if (_h)
+      _h.destroy();
+  }
+
+  /**
+      Starts the coroutine on a MARE worker.
+
+      The coroutine must not have started yet, and this object must
+      outlive it.
+
+      @param group Group that the coroutine belongs to until it
+      completes, or null.
+
+      @return Task that completes when the coroutine does. It is not
+      cancelable: canceling <tt>group</tt> does not stop a coroutine.
+  */
+  task_ptr launch(group_ptr const& group = nullptr)
+  {
+    MARE_API_ASSERT(_h && _h.promise()._done == nullptr,
+                    "coroutine already started");
+    auto done = create_task(with_attrs(
+                              create_task_attrs(internal::attr::non_cancelable),
+                              [] { }));
+    if (group != nullptr)
+      join_group(group, done);
+    _h.promise()._done = done;
+    internal::resume_on_worker(_h);
+    return done;
+  }
+
+  /**
+      Returns the value of the coroutine, once the task returned by
+      launch() has completed.
+
+      @throws The exception that escaped the coroutine, if any.
+  */
+  T get()
+  {
+    MARE_API_ASSERT(_h && _h.done(), "coroutine has not completed");
+    return _h.promise().result();
+  }
+
+  /** @cond */
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> continuation) noexcept
+  {
+    _h.promise()._continuation = continuation;
+    return _h;
+  }
+
+  T await_resume()
+  {
+    return _h.promise().result();
+  }
+  /** @endcond */
+
+private:
+  typedef std::coroutine_handle<promise_type> handle;
+
+  explicit coro_task(handle h) : _h(h) { }
+
+  MARE_DELETE_METHOD(coro_task(coro_task const&));
+  MARE_DELETE_METHOD(coro_task& operator=(coro_task const&));
+
+  handle _h;
+};
+
+/**
+    Returns an awaitable that locks a mutex for a coroutine.
+
+    <tt>co_await mare::lock_async(m)</tt> resumes the coroutine once it
+    has locked <tt>m</tt>, and returns a
+    <tt>std::unique_lock<Mutex></tt> that owns the lock. Works with
+    any mutex that has <tt>try_lock()</tt>, such as mare::mutex.
+
+    @param m Mutex to lock.
+*/
+template<typename Mutex>
+internal::lock_awaiter<Mutex> lock_async(Mutex& m)
+{
+  return internal::lock_awaiter<Mutex>(m);
+}
+/** @} */ /* end_addtogroup execution */
+
+} //namespace mare
+
+#endif // MARE_HAVE_COROUTINES
@@ -57,6 +57,11 @@ struct group_canceled : public single_group_event<__LINE__> {
   */
   bool get_success() const { return _success; }
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::group;
+  }
+
   /** Event name */
   static const char* get_name() {return "group_canceled";}
 
@@ -74,6 +79,11 @@ struct group_created : public single_group_event<__LINE__> {
   group_created(group* g) :
     single_group_event<ID>(g) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::group;
+  }
+
   /** Event name */
   static const char* get_name() {return "group_created";}
 };
@@ -88,6 +98,11 @@ struct group_destroyed : public single_group_event<__LINE__> {
   group_destroyed(group* g) :
     single_group_event<ID>(g) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::group;
+  }
+
   /** Event name */
   static const char* get_name() {return "group_destroyed";}
 };
@@ -102,6 +117,11 @@ struct group_reffed : public group_ref_count_event<__LINE__> {
   group_reffed(group* g, size_t count) :
     group_ref_count_event<ID>(g, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "group_reffed";}
 };
@@ -116,6 +136,11 @@ struct group_unreffed : public group_ref_count_event<__LINE__> {
   group_unreffed(group* g, size_t count) :
     group_ref_count_event<ID>(g, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "group_unreffed";}
 };
@@ -130,6 +155,11 @@ struct object_reffed : public object_ref_count_event<__LINE__> {
   object_reffed(void* o, size_t count) :
     object_ref_count_event<ID>(o, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "object_reffed";}
 };
@@ -144,6 +174,11 @@ struct object_unreffed : public object_ref_count_event<__LINE__> {
   object_unreffed(void* o, size_t count) :
     object_ref_count_event<ID>(o, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "object_unreffed";}
 };
@@ -151,6 +186,11 @@ struct object_unreffed : public object_ref_count_event<__LINE__> {
 /**  User called mare::runtime_shutdown. */
 struct runtime_disabled : public base_event<__LINE__> {
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::runtime;
+  }
+
   /** Event name */
   static const char* get_name() {return "runtime_disabled";}
 };
@@ -167,6 +207,11 @@ struct runtime_enabled : public base_event<__LINE__> {
   /** Returns number of execution contexts */
   size_t get_num_exec_ctx() const { return _num_exec_ctx; }
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::runtime;
+  }
+
   /** Event name */
   static const char* get_name() {return "runtime_enabled";}
 
@@ -174,6 +219,44 @@ private:
   const size_t _num_exec_ctx;
 };
 
+/** SDF node function returns. */
+struct sdf_node_done : public single_sdf_node_event<__LINE__> {
+
+  /**
+     Constructor
+     @param n Pointer to node.
+  */
+  sdf_node_done(sdf_node_common* n) :
+    single_sdf_node_event<ID>(n) {}
+
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::sdf;
+  }
+
+  /** Event name */
+  static const char* get_name() {return "sdf_node_done";}
+};
+
+/** SDF node fires, i.e., its node function is about to be applied. */
+struct sdf_node_executes : public single_sdf_node_event<__LINE__> {
+
+  /**
+     Constructor
+     @param n Pointer to node.
+  */
+  sdf_node_executes(sdf_node_common* n) :
+    single_sdf_node_event<ID>(n) {}
+
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::sdf;
+  }
+
+  /** Event name */
+  static const char* get_name() {return "sdf_node_executes";}
+};
+
 /** User creates dependency between two tasks */
 struct task_after : public dual_task_event<__LINE__> {
 
@@ -190,6 +273,11 @@ struct task_after : public dual_task_event<__LINE__> {
   /** Returns successor task*/
   task* get_succ() const { return get_other_task(); }
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_after";}
 };
@@ -223,6 +311,11 @@ struct task_cleanup : public single_task_event<__LINE__> {
   */
   bool get_in_utcache() const { return _in_utcache; }
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
     static const char* get_name() {return "task_cleanup";}
 
@@ -241,6 +334,11 @@ struct task_created : public single_task_event<__LINE__> {
   task_created(task* g) :
     single_task_event<ID>(g) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
     static const char* get_name() {return "task_created";}
 };
@@ -255,6 +353,11 @@ struct task_destroyed : public single_task_event<__LINE__> {
   task_destroyed(task* t) :
     single_task_event<ID>(t) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_destroyed";}
 };
@@ -269,6 +372,11 @@ struct task_done : public single_task_event<__LINE__> {
   task_done(task* t) :
     single_task_event<ID>(t) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_done";}
 };
@@ -284,6 +392,11 @@ struct task_executes : public single_task_event<__LINE__> {
   task_executes(task* t) :
     single_task_event<ID>(t) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_executes";}
 };
@@ -298,6 +411,11 @@ struct task_sent_to_runtime : public single_task_event<__LINE__> {
   task_sent_to_runtime(task* t) :
     single_task_event<ID>(t) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_sent_to_runtime";}
 };
@@ -312,6 +430,11 @@ struct task_reffed : public task_ref_count_event<__LINE__> {
   task_reffed(task* t, size_t count) :
     task_ref_count_event<ID>(t, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_reffed";}
 };
@@ -326,6 +449,11 @@ struct task_unreffed : public task_ref_count_event<__LINE__> {
   task_unreffed(task* t, size_t count) :
     task_ref_count_event<ID>(t, count) {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::refcount;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_unreffed";}
 };
@@ -353,6 +481,11 @@ struct task_wait : public single_task_event<__LINE__> {
     return _wait_required;
   }
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::task;
+  }
+
   /** Event name */
   static const char* get_name() {return "task_wait";}
 
@@ -369,6 +502,11 @@ struct ws_tree_new_slab : public base_event<__LINE__> {
   ws_tree_new_slab() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
   /** Event name */
   static const char* get_name() {return "ws_tree_new_slab";}
 };
@@ -383,6 +521,11 @@ struct ws_tree_node_created : public base_event<__LINE__> {
   ws_tree_node_created() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
   /** Event name */
   static const char* get_name() {return "ws_tree_node_created";}
 };
@@ -392,6 +535,11 @@ struct ws_tree_worker_try_own : public base_event<__LINE__> {
   ws_tree_worker_try_own() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
   /** Event name */
   static const char* get_name() {return "ws_tree_worker_try_own";}
 };
@@ -401,6 +549,11 @@ struct ws_tree_try_own_success : public base_event<__LINE__> {
   ws_tree_try_own_success() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
     /** Event name */
   static const char* get_name() {return "ws_tree_try_own_success";}
 };
@@ -410,6 +563,11 @@ struct ws_tree_worker_try_steal : public base_event<__LINE__> {
   ws_tree_worker_try_steal() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
   /** Event name */
   static const char* get_name() {return "ws_tree_worker_try_steal";}
 };
@@ -419,6 +577,11 @@ struct ws_tree_try_steal_success : public base_event<__LINE__> {
   ws_tree_try_steal_success() :
   base_event<ID>() {}
 
+  /** Event class */
+  static constexpr event_class_set get_class() {
+    return event_class::pfor;
+  }
+
   /** Event name */
   static const char* get_name() {return "ws_tree_try_steal_success";}
 };
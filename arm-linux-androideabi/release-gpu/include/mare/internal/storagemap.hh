@@ -43,8 +43,10 @@ private:
     void (*dtor)(void*); /// destructor to run at end of life-time, or null
   };
 
-  /// \todo evaluate inlining first few elements to avoid allocation
-  ///       for common case
+  /// Inlining the first few elements would save the allocation and one
+  /// indirection in the common case, but storage_map is a member of task
+  /// and is accessed from within libmare, so its layout cannot change
+  /// without rebuilding the library.
   std::unique_ptr<std::vector<task_storage_item> > _map;
 
 public:
@@ -0,0 +1,219 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <mare/common.hh>
+#include <mare/internal/synchronization/mutex.hh>
+#include <mare/internal/tls.hh>
+
+namespace mare{
+
+namespace internal{
+
+/// Reader-writer lock for read-mostly data.
+///
+/// Readers announce themselves in one of several reader counters instead
+/// of a single shared one, so concurrent readers on different workers do
+/// not bounce a cache line between them. A thread always uses the same
+/// counter, picked by hashing its thread id. A task that migrates while
+/// holding the lock may decrement a different counter than it
+/// incremented, so counters are signed and only their sum is meaningful.
+///
+/// Writers are preferred: _writers counts the writers that hold or wait
+/// for the lock, and no reader enters while it is nonzero. Writers
+/// serialize on a mare::mutex, and the writer that holds it waits for the
+/// sum of the reader counters to drop to zero. The Dekker-style handshake
+/// (a reader increments its counter and then reads _writers; a writer
+/// increments _writers and then reads the counters) relies on both sides
+/// using sequentially consistent atomics.
+///
+/// Readers and writers first spin with backoff, then yield to the MARE
+/// scheduler, and finally block on a futex, as mare::mutex does, so the
+/// workers keep running other tasks. Blocked readers wait on
+/// _reader_futex for _writers to drop to zero; the writer waits on
+/// _writer_futex and is woken by the readers leaving.
+class shared_mutex {
+private:
+  static const size_t cache_line_size = 64;
+
+  struct reader_count {
+    std::atomic<long> _count;
+    char _pad[cache_line_size - sizeof(std::atomic<long>)];
+
+    reader_count() : _count(0), _pad() {}
+  };
+
+  size_t _num_slots;
+  std::unique_ptr<reader_count[]> _readers;
+  std::atomic<int> _writers;
+  // Number of readers that may be blocked on _reader_futex
+  std::atomic<int> _sleeping_readers;
+  // 1 if the writer may be blocked on _writer_futex; the writer waits on
+  // this word, so that it notices a reader clearing it before wait()
+  std::atomic<int> _writer_sleeping;
+  mutex _writer_mutex;
+  futex _reader_futex;
+  futex _writer_futex;
+
+public:
+  static const int YIELD_THRESHOLD = 10;
+
+  shared_mutex() :
+    _num_slots(std::max<size_t>(std::thread::hardware_concurrency(), 1)),
+    _readers(new reader_count[_num_slots]),
+    _writers(0),
+    _sleeping_readers(0),
+    _writer_sleeping(0),
+    _writer_mutex(),
+    _reader_futex(),
+    _writer_futex() {}
+
+  MARE_DELETE_METHOD(shared_mutex(shared_mutex&));
+  MARE_DELETE_METHOD(shared_mutex(shared_mutex&&));
+  MARE_DELETE_METHOD(shared_mutex& operator=(shared_mutex const&));
+  MARE_DELETE_METHOD(shared_mutex& operator=(shared_mutex&&));
+
+  void lock() {
+    _writers.fetch_add(1);
+    _writer_mutex.lock();
+    wait_for_readers();
+  }
+
+  bool try_lock() {
+    if (!_writer_mutex.try_lock())
+      return false;
+    _writers.fetch_add(1);
+    if (readers() == 0)
+      return true;
+    _writer_mutex.unlock();
+    leave_writer();
+    return false;
+  }
+
+  void unlock() {
+    _writer_mutex.unlock();
+    leave_writer();
+  }
+
+  void lock_shared() {
+    std::atomic<long>& count = slot();
+    for (;;) {
+      count.fetch_add(1);
+      if (_writers.load() == 0)
+        return;
+      leave_reader(count);
+      wait_for_writers();
+    }
+  }
+
+  bool try_lock_shared() {
+    std::atomic<long>& count = slot();
+    count.fetch_add(1);
+    if (_writers.load() == 0)
+      return true;
+    leave_reader(count);
+    return false;
+  }
+
+  void unlock_shared() {
+    leave_reader(slot());
+  }
+
+private:
+  std::atomic<long>& slot() {
+    // Thread ids are addresses of thread control blocks, which are
+    // page aligned and far apart; mix the bits before taking the modulo
+    uint64_t id = static_cast<uint64_t>(thread_id()) >> 12;
+    id *= 0x9e3779b97f4a7c15ULL;
+    return _readers[(id >> 32) % _num_slots]._count;
+  }
+
+  long readers() {
+    long sum = 0;
+    for (size_t i = 0; i < _num_slots; ++i)
+      sum += _readers[i]._count.load();
+    return sum;
+  }
+
+  void leave_reader(std::atomic<long>& count) {
+    count.fetch_sub(1);
+    // The writer may be waiting for us
+    if (_writer_sleeping.load() == 1 && _writer_sleeping.exchange(0) == 1)
+      _writer_futex.wakeup(1);
+  }
+
+  void leave_writer() {
+    if (_writers.fetch_sub(1) == 1 && _sleeping_readers.load() != 0)
+      _reader_futex.wakeup(1);
+  }
+
+  // Called by the writer that holds _writer_mutex. Futex wakeups are
+  // not free, so both sides advertise that they may be asleep, and the
+  // other side only calls wakeup() if so. futex::wakeup() does nothing
+  // if the waiter has not entered wait() yet, so each side waits on a
+  // word that the other side changes before calling wakeup().
+  void wait_for_readers() {
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      if (readers() == 0)
+        return;
+      backoff.pause();
+    }
+    for (int i = 0; i < YIELD_THRESHOLD; ++i) {
+      if (readers() == 0)
+        return;
+      yield();
+    }
+    for (;;) {
+      _writer_sleeping.store(1);
+      if (readers() == 0)
+        break;
+      _writer_futex.wait(&_writer_sleeping, 1);
+    }
+    _writer_sleeping.store(0);
+  }
+
+  void wait_for_writers() {
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      if (_writers.load() == 0)
+        return;
+      backoff.pause();
+    }
+    for (int i = 0; i < YIELD_THRESHOLD; ++i) {
+      if (_writers.load() == 0)
+        return;
+      yield();
+    }
+    // futex::wakeup() misses readers that have not entered wait() yet, so
+    // rather than broadcasting, each reader that wakes up wakes up the
+    // next one; wakeup(1) waits for a reader that is about to block.
+    _sleeping_readers.fetch_add(1);
+    int writers;
+    while ((writers = _writers.load()) != 0)
+      _reader_futex.wait(&_writers, writers);
+    if (_sleeping_readers.fetch_sub(1) > 1)
+      _reader_futex.wakeup(1);
+  }
+};
+
+}; //namespace internal
+
+}; //namespace mare
@@ -36,9 +36,11 @@ namespace mare
     execution.  It returns immediately if the task has already
     finished.  If <tt>wait_for(mare::task_ptr)</tt> is called from
     within a task, MARE context-switches the task and finds another
-    one to run. If called from outside a task (i.e., the main thread),
-    MARE blocks the thread until <tt>wait_for(mare::task_ptr)</tt>
-    returns.
+    one to run. If called from a fiber (see mare::launch_fiber), the
+    fiber is suspended and the worker runs other tasks until the target
+    task completes. If called from outside a task (i.e., the main
+    thread), MARE blocks the thread until
+    <tt>wait_for(mare::task_ptr)</tt> returns.
 
     This method is a safe point. Safe points are MARE API methods
     where the following property holds:
@@ -59,7 +61,10 @@ inline void wait_for(task_ptr const& task)
 {
   auto t_ptr = internal::c_ptr(task);
   MARE_API_ASSERT(t_ptr, "null task_ptr");
-  t_ptr->wait();
+  if (auto f = internal::current_fiber())
+    f->wait_for(t_ptr);
+  else
+    t_ptr->wait();
 }
 
 /**
@@ -78,7 +83,66 @@ inline void wait_for(unsafe_task_ptr const& task)
 {
   auto t_ptr = internal::c_ptr(task);
   MARE_API_ASSERT(t_ptr, "null unsafe_task_ptr");
-  t_ptr->wait();
+  if (auto f = internal::current_fiber())
+    f->wait_for(t_ptr);
+  else
+    t_ptr->wait();
+}
+
+/**
+    Waits for task to complete execution, or until a point in time.
+
+    See mare::wait_for(task_ptr const&,
+                       std::chrono::duration<Rep, Period> const&).
+
+    @param task Pointer to target task.
+    @param timeout_time Time to wait until.
+
+    @return
+    TRUE -- The task finished before timeout_time.\n
+    FALSE -- timeout_time was reached first.
+
+    @throws api_exception If task points to null.
+*/
+template<class Clock, class Duration>
+bool wait_until(task_ptr const& task,
+                std::chrono::time_point<Clock, Duration> const& timeout_time)
+{
+  auto t_ptr = internal::c_ptr(task);
+  MARE_API_ASSERT(t_ptr, "null task_ptr");
+  return internal::poll_until([t_ptr] {
+      return t_ptr->get_state().is_done();
+    }, timeout_time);
+}
+
+/**
+    Waits for task to complete execution, or for a timeout.
+
+    Returns when the task finishes, or once rel_time has passed,
+    whichever comes first. Unlike <tt>wait_for(mare::task_ptr)</tt>,
+    the caller does not block: if called from within a task, the task
+    yields to the MARE scheduler between checks, so the worker thread
+    keeps executing other tasks. The task is not canceled on timeout.
+
+    This method is a safe point.
+
+    @param task Pointer to target task.
+    @param rel_time Maximum time to wait.
+
+    @return
+    TRUE -- The task finished before the timeout.\n
+    FALSE -- The timeout occurred first.
+
+    @throws api_exception If task points to null.
+
+    @sa mare::wait_until(task_ptr const&,
+                         std::chrono::time_point<Clock, Duration> const&)
+*/
+template<class Rep, class Period>
+bool wait_for(task_ptr const& task,
+              std::chrono::duration<Rep, Period> const& rel_time)
+{
+  return wait_until(task, std::chrono::steady_clock::now() + rel_time);
 }
 /** @} */ /* end_addtogroup sync */
 
@@ -0,0 +1,122 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <list>
+#include <map>
+
+#include <mare/internal/debug.hh>
+#include <mare/arena.hh>
+#include <mare/mare.h>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::group_arena and mare::arena_allocator,
+//     and
+//  2. compare them to malloc on requests whose tasks allocate many
+//     short-lived objects.
+//
+//  Every request creates a group and launches num_tasks tasks into it.
+//  Each task builds a std::map and a std::list of num_objects elements,
+//  i.e., two small allocations per element, and sums them up. With an
+//  arena, the elements come from the arena of the request's group and
+//  are reclaimed all at once when the request is done.
+
+const std::size_t num_requests = 200;
+const std::size_t num_tasks = 32;
+const std::size_t num_objects = 1000;
+
+struct with_malloc {
+  typedef std::list<std::size_t> list;
+  typedef std::map<std::size_t, std::size_t> map;
+
+  static list make_list(mare::group_ptr const&) { return list(); }
+  static map make_map(mare::group_ptr const&) { return map(); }
+  static void done(mare::group_ptr const&) {}
+  static const char* name() { return "malloc"; }
+};
+
+struct with_arena {
+  typedef mare::arena_allocator<std::size_t> list_allocator;
+  typedef mare::arena_allocator<std::pair<const std::size_t, std::size_t> >
+    map_allocator;
+  typedef std::list<std::size_t, list_allocator> list;
+  typedef std::map<std::size_t, std::size_t, std::less<std::size_t>,
+                   map_allocator> map;
+
+  static list make_list(mare::group_ptr const& g)
+  {
+    return list(list_allocator(mare::group_arena(g)));
+  }
+  static map make_map(mare::group_ptr const& g)
+  {
+    return map(std::less<std::size_t>(), map_allocator(mare::group_arena(g)));
+  }
+  static void done(mare::group_ptr const& g) { mare::release_group_arena(g); }
+  static const char* name() { return "arena"; }
+};
+
+template<typename Mode>
+void
+run()
+{
+  std::atomic<std::size_t> sum(0);
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t r = 0; r < num_requests; r++) {
+    auto g = mare::create_group();
+    for (std::size_t t = 0; t < num_tasks; t++) {
+      mare::launch(g, [g, &sum] {
+          auto l = Mode::make_list(g);
+          auto m = Mode::make_map(g);
+          for (std::size_t i = 0; i < num_objects; i++) {
+            l.push_back(i);
+            m[i] = i;
+          }
+          std::size_t s = 0;
+          for (auto v : l)
+            s += v;
+          for (auto const& kv : m)
+            s += kv.second;
+          sum += s;
+        });
+    }
+    mare::wait_for(g);
+    Mode::done(g);
+  }
+  auto end = std::chrono::system_clock::now();
+
+  assert(sum == num_requests * num_tasks * num_objects * (num_objects - 1));
+  MARE_UNUSED(sum);
+  MARE_LLOG("%-7s %10.4f s", Mode::name(),
+            std::chrono::duration<double>(end - start).count());
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("mode        time");
+  run<with_malloc>();
+  run<with_arena>();
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
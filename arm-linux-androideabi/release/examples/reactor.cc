@@ -0,0 +1,110 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <mare/mare.h>
+#include <mare/io.hh>
+
+using namespace std;
+
+///////////////
+//
+//  Goal is to
+//  1. launch a task when a pipe becomes readable with
+//     mare::launch_on_readable(group, fd, body), instead of blocking a
+//     worker in read(),
+//  2. echo over a socketpair with mare::launch_on_writable and
+//     mare::read_async, and
+//  3. read a regular file with mare::read_async, which uses pread on the
+//     reactor thread because epoll cannot poll files.
+
+int main() {
+
+  // Initialize the MARE runtime.
+  mare::runtime::init();
+  auto group = mare::create_group();
+
+  // 1. Pipe. The task is launched only once the writer below runs.
+  int p[2];
+  if (pipe(p) != 0)
+    MARE_FATAL("pipe failed");
+  char pipe_buf[32] = {0};
+  mare::launch_on_readable(group, p[0], [&] {
+      ssize_t n = read(p[0], pipe_buf, sizeof(pipe_buf) - 1);
+      MARE_ALOG("pipe: read %zd bytes: %s", n, pipe_buf);
+    });
+  mare::launch(group, [&] {
+      char const msg[] = "hello";
+      ssize_t n = write(p[1], msg, strlen(msg));
+      MARE_UNUSED(n);
+    });
+  mare::wait_for(group);
+
+  // 2. Socketpair.
+  int s[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, s) != 0)
+    MARE_FATAL("socketpair failed");
+  char sock_buf[32] = {0};
+  mare::read_async(group, s[1], sock_buf, sizeof(sock_buf) - 1, 0,
+                   [&] (ssize_t n) {
+                     MARE_ALOG("socket: read %zd bytes: %s", n, sock_buf);
+                   });
+  mare::launch_on_writable(group, s[0], [&] {
+      char const msg[] = "ping";
+      ssize_t n = write(s[0], msg, strlen(msg));
+      MARE_UNUSED(n);
+    });
+  mare::wait_for(group);
+
+  // 3. Regular file.
+  FILE* f = tmpfile();
+  if (f == nullptr)
+    MARE_FATAL("tmpfile failed");
+  fputs("0123456789", f);
+  fflush(f);
+  char file_buf[8] = {0};
+  mare::read_async(group, fileno(f), file_buf, 4, 3,
+                   [&] (ssize_t n) {
+                     MARE_ALOG("file: read %zd bytes at offset 3: %s",
+                               n, file_buf);
+                   });
+  mare::wait_for(group);
+
+  // A canceled group drops the reads that are still pending.
+  auto canceled = mare::create_group();
+  mare::read_async(canceled, p[0], pipe_buf, sizeof(pipe_buf), 0,
+                   [] (ssize_t) {
+                     MARE_ALOG("never runs");
+                   });
+  mare::cancel(canceled);
+  mare::wait_for(canceled);
+
+  fclose(f);
+  for (int fd : {p[0], p[1], s[0], s[1]})
+    close(fd);
+
+  // Shutdown the MARE runtime.
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/mutex.hh>
+#include <mare/shared_mutex.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::shared_mutex to protect read-mostly
+//     data, and
+//  2. compare it against mare::mutex, which serializes the readers.
+//
+//  A table of settings is read by many tasks and occasionally
+//  rewritten. A writer sets all entries to the same new value, so a
+//  reader that sees two different values has observed a torn update.
+
+const std::size_t table_size = 64;
+const std::size_t num_tasks = 32;
+const std::size_t ops_per_task = 1 << 14;
+
+struct exclusive {
+  mare::mutex m;
+  void lock_shared() { m.lock(); }
+  void unlock_shared() { m.unlock(); }
+  void lock() { m.lock(); }
+  void unlock() { m.unlock(); }
+};
+
+// Returns the number of operations per second. One in every
+// write_interval operations is a write.
+template<typename Mutex>
+double
+run(std::size_t write_interval)
+{
+  Mutex m;
+  std::vector<std::size_t> table(table_size, 0);
+
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_tasks; t++) {
+    mare::launch(g, [&m, &table, t, write_interval] {
+        for (std::size_t i = 0; i < ops_per_task; i++) {
+          if ((t * ops_per_task + i) % write_interval == 0) {
+            m.lock();
+            for (auto& entry : table)
+              entry = entry + 1;
+            m.unlock();
+          } else {
+            m.lock_shared();
+            std::size_t first = table[0];
+            bool consistent = true;
+            for (auto entry : table)
+              consistent = consistent && entry == first;
+            m.unlock_shared();
+            assert(consistent);
+            MARE_UNUSED(consistent);
+          }
+        }
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  assert(table[0] == (num_tasks * ops_per_task + write_interval - 1) /
+                     write_interval);
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_tasks * ops_per_task) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("writes        mare::mutex  mare::shared_mutex");
+  std::size_t const write_intervals[] = {2, 16, 1024};
+  for (auto write_interval : write_intervals) {
+    double plain = run<exclusive>(write_interval);
+    double shared = run<mare::shared_mutex>(write_interval);
+    MARE_LLOG("1/%-8zu %14.1f %19.1f ops/s (%.2fx)",
+              write_interval, plain, shared, shared / plain);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
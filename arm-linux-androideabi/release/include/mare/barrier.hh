@@ -20,6 +20,7 @@
 namespace mare{
 /** @cond */
 typedef internal::sense_barrier barrier;
+typedef internal::tree_barrier tree_barrier;
 /** @endcond */
 
 }; //namespace mare
@@ -35,6 +36,9 @@ namespace mare {
 
     Synchronizes multiple tasks (or threads) at the point where
     wait() is called without blocking the MARE scheduler.
+
+    All tasks count down a single counter. See tree_barrier for an
+    alternative that spreads the updates over several counters.
 */
 class barrier{
 public:
@@ -59,6 +63,40 @@ public:
   */
   void wait();
 };
+
+/**
+    Synchronizes multiple tasks at the call to wait(), using a combining
+    tree.
+
+    Behaves like barrier, but no more than 4 tasks update the same
+    counter: the tasks arrive at the leaves of a tree with a fan-in of 4,
+    and the last task to arrive at a node moves on to its parent. This
+    only pays off if many participants run in parallel on many cores;
+    otherwise, barrier is faster.
+*/
+class tree_barrier{
+public:
+
+  /**
+      Constructs the barrier, given the number of tasks
+      that will wait on it.
+
+      @param total Number of tasks that will wait on the barrier.
+  */
+  explicit tree_barrier(size_t total);
+
+  tree_barrier(tree_barrier&) = delete;
+  tree_barrier(tree_barrier&&) = delete;
+  tree_barrier& operator=(tree_barrier const&) = delete;
+  tree_barrier& operator=(tree_barrier&&) = delete;
+
+  /**
+      Wait on the barrier.
+
+      Task may yield to the MARE scheduler.
+  */
+  void wait();
+};
 /** @} */ /* end_addtogroup sync */
 };
 
@@ -0,0 +1,205 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/tlsptr.hh>
+
+namespace mare {
+
+namespace internal {
+
+///
+/// Per-thread free lists of nodes of type TN.
+///
+/// Meant to back the class-level operator new and delete of a node type
+/// that is allocated and freed at a high rate, such as the nodes of a
+/// concurrent queue. deallocate() keeps the memory of a node in a free
+/// list of the calling thread, and allocate() takes it from there
+/// without synchronization.
+///
+/// In producer/consumer patterns, nodes are mostly allocated by one set
+/// of threads and freed (often by the reclamation scheme) by another.
+/// Therefore, when a free list grows beyond 2 * batch_size nodes, a batch
+/// of batch_size nodes is moved to a shared stash, from which threads with
+/// an empty free list take a whole batch at a time. The stash holds at
+/// most max_batches batches; beyond that, nodes are returned to malloc.
+/// Both default to 64, which suits small nodes; caches of large blocks
+/// pass smaller values to bound the memory they hold on to.
+///
+/// The memory of the nodes is obtained with malloc, as with
+/// MARE_OPERATOR_NEW_OVERRIDE. When a thread exits, the nodes in its free
+/// list are freed.
+///
+template<typename TN, size_t BatchSize = 64, size_t MaxBatches = 64>
+class node_cache {
+public:
+  static const size_t batch_size = BatchSize;
+  static const size_t max_batches = MaxBatches;
+
+  /// Counts of the calling thread, for tuning and benchmarks. They are
+  /// per thread, so that counting does not add contention.
+  struct stats {
+    size_t _hits;      // allocations served from the free list
+    size_t _refills;   // batches taken from the stash
+    size_t _misses;    // allocations that had to call malloc
+    size_t _spills;    // batches moved to the stash
+  };
+
+  static void* allocate(std::size_t size) {
+    MARE_INTERNAL_ASSERT(size == sizeof(TN),
+                         "node_cache only allocates single nodes");
+    local* l = get_local();
+    if (l->_head == nullptr && !l->refill()) {
+      l->_stats._misses++;
+      void* mem = malloc(size);
+      if (mem == nullptr)
+        throw std::bad_alloc();
+      return mem;
+    }
+    free_node* n = l->_head;
+    l->_head = n->_next;
+    l->_count--;
+    l->_stats._hits++;
+    return n;
+  }
+
+  static void deallocate(void* p) {
+    if (p == nullptr)
+      return;
+    local* l = get_local();
+    free_node* n = static_cast<free_node*>(p);
+    n->_next = l->_head;
+    l->_head = n;
+    if (++l->_count > 2 * batch_size)
+      l->spill();
+  }
+
+  static stats thread_stats() {
+    return get_local()->_stats;
+  }
+
+private:
+  static_assert(sizeof(TN) >= sizeof(void*),
+                "node must be large enough to hold a free list link");
+
+  struct free_node {
+    free_node* _next;
+  };
+
+  // Batches of batch_size nodes, linked through _next
+  struct stash {
+    std::mutex _mutex;
+    std::vector<free_node*> _batches;
+
+    stash() : _mutex(), _batches() {
+      _batches.reserve(max_batches);
+    }
+
+    MARE_DELETE_METHOD(stash(stash const&));
+    MARE_DELETE_METHOD(stash& operator=(stash const&));
+  };
+
+  struct local {
+    free_node* _head;
+    size_t _count;
+    stats _stats;
+
+    local() : _head(nullptr), _count(0), _stats() {}
+
+    MARE_DELETE_METHOD(local(local const&));
+    MARE_DELETE_METHOD(local& operator=(local const&));
+
+    ~local() {
+      while (_head != nullptr) {
+        free_node* n = _head;
+        _head = n->_next;
+        free(n);
+      }
+    }
+
+    bool refill() {
+      stash& s = get_stash();
+      {
+        std::lock_guard<std::mutex> lock(s._mutex);
+        if (s._batches.empty())
+          return false;
+        _head = s._batches.back();
+        s._batches.pop_back();
+      }
+      _count = batch_size;
+      _stats._refills++;
+      return true;
+    }
+
+    // Detaches batch_size nodes from the free list and moves them to the
+    // stash, or frees them if the stash is full
+    void spill() {
+      free_node* batch = _head;
+      free_node* last = _head;
+      for (size_t i = 1; i < batch_size; ++i)
+        last = last->_next;
+      _head = last->_next;
+      last->_next = nullptr;
+      _count -= batch_size;
+      _stats._spills++;
+
+      stash& s = get_stash();
+      {
+        std::lock_guard<std::mutex> lock(s._mutex);
+        if (s._batches.size() < max_batches) {
+          s._batches.push_back(batch);
+          return;
+        }
+      }
+      while (batch != nullptr) {
+        free_node* n = batch;
+        batch = n->_next;
+        free(n);
+      }
+    }
+  };
+
+  static local* get_local() {
+    static tlsptr<local, storage::owner> s_local;
+    local* l = s_local.get();
+    if (l == nullptr) {
+      l = new local();
+      s_local = l;
+    }
+    return l;
+  }
+
+  // Never destroyed, so that threads that exit late can still use it
+  static stash& get_stash() {
+    static stash* s_stash = new stash();
+    return *s_stash;
+  }
+};
+
+template<typename TN, size_t BatchSize, size_t MaxBatches>
+const size_t node_cache<TN, BatchSize, MaxBatches>::batch_size;
+
+template<typename TN, size_t BatchSize, size_t MaxBatches>
+const size_t node_cache<TN, BatchSize, MaxBatches>::max_batches;
+
+} //namespace internal
+
+} //namespace mare
@@ -20,9 +20,12 @@
 #include <vector>
 
 #include <mare/exceptions.hh>
+#include <mare/internal/log/log.hh>
 
 #include <mare/internal/sdf/channelimplementation.hh>
 #include <mare/internal/sdf/sdfnodepolicy.hh>
+#include <mare/internal/sdf/sdfprofile.hh>
+#include <mare/internal/sdf/sdfreplacebody.hh>
 
 
 namespace mare {
@@ -312,6 +315,11 @@ std::tuple<A*, As*...> make_address_of_tuple(A& a, As&... as)
   ///   checking each channel whether it is an input or output channel.
   /// Variants of pop_inputs() and push_outputs() are provided to work
   /// with every choice of node_fn_policy.
+  ///
+  /// Every firing still checks the direction of each channel in vdir,
+  /// and reads or writes each channel through channel* into libmare,
+  /// which dispatches on the channel at run time. The helpers only avoid
+  /// copying the channel vectors and the node-function per firing.
 
 template<size_t index, typename ...Ts>
 typename std::enable_if< (index == 0), bool>::type
@@ -378,7 +386,7 @@ pop_inputs<0>(
 template<size_t index, typename ...Ts>
 typename std::enable_if< (index == 0), bool>::type
 pop_inputs_helper(
-  std::vector<channel*>         vchannels,
+  std::vector<channel*> const&  vchannels,
   std::vector<direction> const& vdir,
   std::tuple<Ts...>&            var_tuple)
 {
@@ -393,7 +401,7 @@ pop_inputs_helper(
 template<size_t index, typename ...Ts>
 typename std::enable_if< (index > 0), bool>::type
 pop_inputs_helper(
-  std::vector<channel*>         vchannels,
+  std::vector<channel*> const&  vchannels,
   std::vector<direction> const& vdir,
   std::tuple<Ts...>&            var_tuple)
 {
@@ -530,7 +538,7 @@ push_outputs<0>(
 template<size_t index, typename ...Ts>
 typename std::enable_if< (index == 0), bool>::type
 push_outputs_helper(
-  std::vector<channel*>         vchannels,
+  std::vector<channel*> const&  vchannels,
   std::vector<direction> const& vdir,
   std::tuple<Ts...>&            var_tuple)
 {
@@ -545,7 +553,7 @@ push_outputs_helper(
 template<size_t index, typename ...Ts>
 typename std::enable_if< (index > 0), bool>::type
 push_outputs_helper(
-  std::vector<channel*>         vchannels,
+  std::vector<channel*> const&  vchannels,
   std::vector<direction> const& vdir,
   std::tuple<Ts...>&            var_tuple)
 {
@@ -627,13 +635,17 @@ push_outputs(
   /// exactly one parameter, with the parameter allowing introspection over
   /// the input and output data values (see node_channels in sdfpr.hh):
   ///      f(node_channels& ncs)
+  ///
+  /// The node-function is passed by reference, as copying a
+  /// node_fn_policy__std_function on every firing would allocate and copy
+  /// the state captured by the body.
 
 template<typename NodeFn,
          size_t last_unpacked_index,
          typename ...Ts,
          typename ...Unpacked>
 typename std::enable_if<(last_unpacked_index == 0), void>::type
-apply_helper(NodeFn f, std::tuple<Ts...>& , Unpacked&... us)
+apply_helper(NodeFn& f, std::tuple<Ts...>& , Unpacked&... us)
 {
   f(us...);
 }
@@ -643,7 +655,7 @@ template<typename NodeFn,
          typename ...Ts,
          typename ...Unpacked>
 typename std::enable_if<(last_unpacked_index > 0), void>::type
-apply_helper(NodeFn f, std::tuple<Ts...>& var_tuple, Unpacked&... us)
+apply_helper(NodeFn& f, std::tuple<Ts...>& var_tuple, Unpacked&... us)
 {
   apply_helper<NodeFn, last_unpacked_index-1>
               (f,
@@ -654,7 +666,7 @@ apply_helper(NodeFn f, std::tuple<Ts...>& var_tuple, Unpacked&... us)
 
 
 template<typename NodeFn, typename ...Ts>
-void apply(NodeFn f, std::tuple<Ts...>& var_tuple)
+void apply(NodeFn& f, std::tuple<Ts...>& var_tuple)
 {
   apply_helper<NodeFn, sizeof...(Ts), Ts...>(f, var_tuple);
 }
@@ -752,6 +764,8 @@ public:
   ///    type-safety via policies.
   ///
   /// See SDF Node Policies in sdfnodepolicy.hh
+  /// See sdfprofile.hh for the measurement of node costs, and
+  /// sdfreplacebody.hh for the replacement of _f.
 
 template<
   template<typename ...> class node_fn_policy,
@@ -759,7 +773,10 @@ template<
   template<typename ...> class channel_init_policy,
   typename ...Ts
 >
-class sdf_node_typed : public sdf_node_common {
+class sdf_node_typed :
+  public sdf_node_common,
+  public sdf_node_profile,
+  public sdf_node_body_replacement<typename node_fn_policy<Ts...>::ftype> {
 public:
   typename node_fn_policy<Ts...>::ftype             _f;
   typename node_fn_policy<Ts...>::valtype           _values;
@@ -773,6 +790,8 @@ public:
     typename channel_init_policy<Ts...>::init_type& channels_initializer
   ) :
     sdf_node_common(g, vdir),
+    sdf_node_profile(),
+    sdf_node_body_replacement<typename node_fn_policy<Ts...>::ftype>(),
     _f(f),
     _values(),
     _cr()
@@ -804,7 +823,16 @@ public:
       ///    over retries
       _applied_f_before_interruption = false;
     } else if(!_was_interrupted || !_applied_f_before_interruption) {
-      apply(_f, _values);
+      this->install_replacement(_f);
+      log::log_event(log::events::sdf_node_executes(this));
+      if(is_profiling()) {
+        auto start = sdf_node_profile::clock::now();
+        apply(_f, _values);
+        record(sdf_node_profile::clock::now() - start);
+      } else {
+        apply(_f, _values);
+      }
+      log::log_event(log::events::sdf_node_done(this));
       _applied_f_before_interruption = true;
     }
     /// else: was interrupted in previous invocation, but after applying f
@@ -906,9 +934,7 @@ sdf_node_ptr create_sdf_node_helper(
                                 Ts...
                                >(g, f, vdir, tp_data_channel);
 
-  sdf_node_common* sdf_node = dynamic_cast<sdf_node_common*>(n);
-  MARE_INTERNAL_ASSERT(sdf_node != nullptr,
-                       "dynamic cast should not have failed");
+  sdf_node_common* sdf_node = n;
 
   std::vector<size_t> vsizes;
   for(auto c : n->get_vchannels())
@@ -918,7 +944,7 @@ sdf_node_ptr create_sdf_node_helper(
 
   add_sdf_node_to_graph(g, sdf_node);
 
-  return dynamic_cast<sdf_node_ptr>(sdf_node);
+  return sdf_node;
 }
 
 
@@ -1130,9 +1156,7 @@ sdf_node_ptr create_sdf_node_helper(
                                 Ts...
                                >(g, f, vdir, vchannels);
 
-  sdf_node_common* sdf_node = dynamic_cast<sdf_node_common*>(n);
-  MARE_INTERNAL_ASSERT(sdf_node != nullptr,
-                       "dynamic cast should not have failed");
+  sdf_node_common* sdf_node = n;
 
   std::vector<size_t> vsizes;
   for(auto c : n->get_vchannels())
@@ -1142,7 +1166,7 @@ sdf_node_ptr create_sdf_node_helper(
 
   add_sdf_node_to_graph(g, sdf_node);
 
-  return dynamic_cast<sdf_node_ptr>(sdf_node);
+  return sdf_node;
 }
 
 
@@ -1206,6 +1230,34 @@ sdf_node_ptr create_sdf_node(
   return internal::sub_create_sdf_node(g, body, v_dir_channels);
 }
 
+namespace internal {
+
+inline
+sdf_node_profile* get_sdf_node_profile(sdf_node_ptr n)
+{
+  MARE_API_ASSERT(n != nullptr, "null sdf_node_ptr");
+  auto profile = dynamic_cast<sdf_node_profile*>(n);
+  MARE_API_ASSERT(profile != nullptr,
+                  "sdf node does not support profiling");
+  return profile;
+}
+
+} //namespace internal
+
+  /// See documentation in sdf.hh
+inline
+void profile_cost(sdf_node_ptr n, std::size_t num_iterations)
+{
+  internal::get_sdf_node_profile(n)->start_profile(num_iterations);
+}
+
+  /// See documentation in sdf.hh
+inline
+double get_measured_cost(sdf_node_ptr n)
+{
+  return internal::get_sdf_node_profile(n)->get_measured_cost();
+}
+
 } //namespace mare
 
 namespace mare {
@@ -20,6 +20,10 @@
 
 #include <cstdlib>
 #include <atomic>
+#include <memory>
+#include <vector>
+
+#include <mare/internal/tls.hh>
 
 // Contains barrier interface for MARE applications
 //
@@ -34,6 +38,11 @@
 //
 // For responsiveness, some amount of spinning is done before
 // yielding to the MARE scheduler
+//
+// With many participants running in parallel, the single _count and
+// _sense may become a bottleneck. tree_barrier, which spreads the
+// arrivals and wakeups over a tree of counters, is available as an
+// alternative, but sense_barrier remains the default.
 
 namespace mare{
 
@@ -81,6 +90,207 @@ private:
   void create_wait_task(bool local_sense);
 };
 
+/// Combining-tree barrier.
+///
+/// Participants arrive at one of the leaves, each of which counts up to
+/// FAN_IN arrivals; the last task to arrive at a node goes on to arrive
+/// at its parent, and the last task to arrive at the root completes the
+/// episode. Every other task waits at the node where it stopped, and is
+/// released when the task that went on returns, top-down. Each node
+/// lives on its own cache line, so at most FAN_IN tasks share a counter
+/// or a release flag.
+///
+/// wait() does not know who calls it, so a task picks its leaf by its
+/// thread id and moves on to the next leaf if that one is full. The leaf
+/// capacities add up to the number of participants, so each leaf fills
+/// up exactly once per episode. A node is reset by the task that releases
+/// it; a task of the next episode that finds a leaf still full from the
+/// previous one simply tries the next leaf.
+///
+/// Waiters spin, then yield to the MARE scheduler, and finally block on
+/// a futex of their node.
+class tree_barrier {
+private:
+  static const size_t cache_line_size = 64;
+  static const size_t no_parent = ~size_t(0);
+
+  struct node {
+    std::atomic<int> _count;
+    int _capacity;
+    size_t _parent;
+    // Last episode whose waiters at this node have been released
+    std::atomic<int> _released;
+    // Tasks that may be blocked at this node, and their futex, for even
+    // and odd episodes. The tasks of the next episode may start waiting
+    // before all of those of the current one have woken up.
+    std::atomic<int> _sleepers[2];
+    futex _futex[2];
+    char _pad[cache_line_size];
+
+    node() : _count(0), _capacity(0), _parent(no_parent), _released(0),
+             _futex(), _pad() {
+      _sleepers[0] = 0;
+      _sleepers[1] = 0;
+    }
+
+    MARE_DELETE_METHOD(node(node const&));
+    MARE_DELETE_METHOD(node& operator=(node const&));
+  };
+
+  size_t _num_leaves;
+  std::unique_ptr<node[]> _nodes;
+  // Number of completed episodes
+  std::atomic<int> _episode;
+
+public:
+  static const size_t FAN_IN = 4;
+  static const int YIELD_THRESHOLD = 10;
+
+  explicit tree_barrier(size_t total) :
+    _num_leaves(0),
+    _nodes(),
+    _episode(0) {
+    MARE_API_ASSERT(total > 0, "barrier needs at least one participant");
+
+    // Capacities of the nodes on each level, leaves first
+    std::vector<std::vector<int>> levels;
+    levels.push_back(group(total));
+    while (levels.back().size() > 1)
+      levels.push_back(group(levels.back().size()));
+
+    size_t num_nodes = 0;
+    for (auto& level : levels)
+      num_nodes += level.size();
+    _num_leaves = levels[0].size();
+    _nodes.reset(new node[num_nodes]);
+
+    // Node i of a level is the parent of nodes FAN_IN * i to
+    // FAN_IN * i + FAN_IN - 1 of the level below
+    size_t first = 0;
+    for (size_t l = 0; l < levels.size(); ++l) {
+      size_t next = first + levels[l].size();
+      for (size_t i = 0; i < levels[l].size(); ++i) {
+        _nodes[first + i]._capacity = levels[l][i];
+        if (l + 1 < levels.size())
+          _nodes[first + i]._parent = next + i / FAN_IN;
+      }
+      first = next;
+    }
+  }
+
+  MARE_DELETE_METHOD(tree_barrier(tree_barrier&));
+  MARE_DELETE_METHOD(tree_barrier(tree_barrier&&));
+  MARE_DELETE_METHOD(tree_barrier& operator=(tree_barrier const&));
+  MARE_DELETE_METHOD(tree_barrier& operator=(tree_barrier&&));
+
+  void wait() {
+    // Our previous wait() returned only after the episode count was
+    // advanced, so this is the episode we are arriving for
+    int episode = _episode.load();
+
+    // Nodes at which we were the last to arrive, bottom-up
+    size_t won[64];
+    size_t num_won = 0;
+
+    int arrived;
+    size_t n = join_leaf(arrived);
+    for (;;) {
+      node& nd = _nodes[n];
+      if (arrived < nd._capacity) {
+        wait_at(nd, episode);
+        break;
+      }
+      won[num_won++] = n;
+      if (nd._parent == no_parent) {
+        _episode.store(next(episode));
+        break;
+      }
+      n = nd._parent;
+      arrived = _nodes[n]._count.fetch_add(1) + 1;
+    }
+
+    // Release the waiters at the nodes we won, top-down. A node is reset
+    // before its waiters are released, so that the tasks we release
+    // find their leaves empty for the next episode.
+    while (num_won > 0) {
+      node& nd = _nodes[won[--num_won]];
+      nd._count.store(0);
+      nd._released.store(next(episode));
+      if (nd._sleepers[episode & 1].load() != 0)
+        nd._futex[episode & 1].wakeup(1);
+    }
+  }
+
+private:
+  // Capacities of the parents of num_children nodes
+  static std::vector<int> group(size_t num_children) {
+    std::vector<int> capacities;
+    for (size_t i = 0; i < num_children; i += FAN_IN)
+      capacities.push_back(static_cast<int>(
+                             std::min(FAN_IN, num_children - i)));
+    return capacities;
+  }
+
+  static int next(int episode) {
+    return static_cast<int>(static_cast<unsigned>(episode) + 1);
+  }
+
+  // Counts us in at the first leaf with room, starting from our own.
+  // Returns the leaf, and in arrived its count including us. All leaves
+  // may still be full from the previous episode, until the tasks that
+  // release them get to run, so we back off after each round over the
+  // leaves, and then yield.
+  size_t join_leaf(int& arrived) {
+    uint64_t id = static_cast<uint64_t>(thread_id()) >> 12;
+    id *= 0x9e3779b97f4a7c15ULL;
+    size_t const first = (id >> 32) % _num_leaves;
+    size_t leaf = first;
+    spin_backoff backoff;
+    for (;;) {
+      node& nd = _nodes[leaf];
+      int count = nd._count.load();
+      while (count < nd._capacity) {
+        if (nd._count.compare_exchange_weak(count, count + 1)) {
+          arrived = count + 1;
+          return leaf;
+        }
+      }
+      if (++leaf == _num_leaves)
+        leaf = 0;
+      if (leaf != first)
+        continue;
+      if (backoff.saturated())
+        yield();
+      else
+        backoff.pause();
+    }
+  }
+
+  static void wait_at(node& nd, int episode) {
+    spin_backoff backoff;
+    while (!backoff.saturated()) {
+      if (nd._released.load() != episode)
+        return;
+      backoff.pause();
+    }
+    for (int i = 0; i < YIELD_THRESHOLD; ++i) {
+      if (nd._released.load() != episode)
+        return;
+      yield();
+    }
+    // futex::wakeup() misses tasks that have not entered wait() yet, so
+    // rather than broadcasting, each task that wakes up wakes up the
+    // next one; wakeup(1) waits for a task that is about to block.
+    std::atomic<int>& sleepers = nd._sleepers[episode & 1];
+    futex& f = nd._futex[episode & 1];
+    sleepers.fetch_add(1);
+    while (nd._released.load() == episode)
+      f.wait(&nd._released, episode);
+    if (sleepers.fetch_sub(1) > 1)
+      f.wakeup(1);
+  }
+};
+
 }; //namespace internal
 
 }; //namespace mare
@@ -0,0 +1,317 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Hierarchical timing wheel.
+///
+/// Deadlines are measured in ticks of TICK. Level 0 has one slot per tick
+/// for the next SLOTS ticks; each level above has slots that are SLOTS
+/// times coarser. An entry is filed in the lowest level whose range
+/// covers its distance to the current tick, under the slot indexed by
+/// the bits of its absolute deadline for that level. Whenever the
+/// level-l index wraps to zero, the slot of level l+1 that just became
+/// current is cascaded, i.e., its entries are refiled one or more levels
+/// down. Insertion is therefore O(1), and every entry is moved at most
+/// once per level before it expires. Deadlines beyond the range of the
+/// top level are parked in its last slot and refiled when it cascades.
+///
+/// The wheel is not thread-safe; timer_service serializes all accesses.
+class timer_wheel {
+public:
+  typedef std::chrono::milliseconds tick_duration;
+  typedef std::uint64_t tick_t;
+
+  /// Returns true if the entry should be rearmed _period ticks later.
+  typedef std::function<bool()> callback;
+
+  struct entry {
+    entry* _next;
+    tick_t _deadline;
+    tick_t _period;
+    callback _callback;
+
+    entry(tick_t deadline, tick_t period, callback&& cb) :
+      _next(nullptr),
+      _deadline(deadline),
+      _period(period),
+      _callback(std::move(cb)) { }
+
+    MARE_DELETE_METHOD(entry(entry const&));
+    MARE_DELETE_METHOD(entry& operator=(entry const&));
+  };
+
+  timer_wheel() :
+    _now(0),
+    _size(0),
+    _slots() { }
+
+  ~timer_wheel()
+  {
+    for (auto& level : _slots)
+      for (auto& slot : level)
+        while (slot != nullptr) {
+          entry* e = slot;
+          slot = e->_next;
+          delete e;
+        }
+  }
+
+  tick_t now() const { return _now; }
+  bool empty() const { return _size == 0; }
+
+  /// Files e. Deadlines that are not in the future expire on the next tick.
+  void insert(entry* e)
+  {
+    if (e->_deadline <= _now)
+      e->_deadline = _now + 1;
+    file(e);
+    ++_size;
+  }
+
+  /// Advances the wheel to tick t and returns the expired entries, linked
+  /// through _next in expiration order. The entries are no longer in the
+  /// wheel: the caller either deletes or reinserts them.
+  entry* advance(tick_t t)
+  {
+    entry* expired = nullptr;
+    entry** tail = &expired;
+    while (_now < t) {
+      ++_now;
+      for (size_t level = 1; level < LEVELS; ++level) {
+        if (index(_now, level - 1) != 0)
+          break;
+        cascade(level);
+      }
+      entry*& slot = _slots[0][index(_now, 0)];
+      if (slot == nullptr)
+        continue;
+      *tail = slot;
+      while (*tail != nullptr) {
+        MARE_INTERNAL_ASSERT((*tail)->_deadline == _now,
+                             "timer filed in the wrong slot");
+        --_size;
+        tail = &(*tail)->_next;
+      }
+      slot = nullptr;
+    }
+    return expired;
+  }
+
+  /// Earliest tick at which advance() may have work to do: the next
+  /// non-empty level-0 slot, or the next cascade, whichever comes first.
+  tick_t next_event() const
+  {
+    tick_t t = _now + 1;
+    for (; index(t, 0) != 0; ++t)
+      if (_slots[0][index(t, 0)] != nullptr)
+        return t;
+    return t;
+  }
+
+private:
+  static const size_t SLOT_BITS = 6;
+  static const size_t SLOTS = size_t(1) << SLOT_BITS;
+  static const size_t LEVELS = 4;
+
+  static size_t index(tick_t t, size_t level)
+  {
+    return static_cast<size_t>(t >> (level * SLOT_BITS)) & (SLOTS - 1);
+  }
+
+  void file(entry* e)
+  {
+    tick_t delta = e->_deadline - _now;
+    tick_t placed = e->_deadline;
+    size_t level = 0;
+    while (level < LEVELS - 1 &&
+           delta >= (tick_t(1) << ((level + 1) * SLOT_BITS)))
+      ++level;
+    if (level == LEVELS - 1 && delta >= (tick_t(1) << (LEVELS * SLOT_BITS)))
+      placed = _now + (tick_t(1) << (LEVELS * SLOT_BITS)) - 1;
+    entry*& slot = _slots[level][index(placed, level)];
+    e->_next = slot;
+    slot = e;
+  }
+
+  void cascade(size_t level)
+  {
+    entry*& slot = _slots[level][index(_now, level)];
+    entry* e = slot;
+    slot = nullptr;
+    while (e != nullptr) {
+      entry* next = e->_next;
+      file(e);
+      e = next;
+    }
+  }
+
+  tick_t _now;
+  size_t _size;
+  entry* _slots[LEVELS][SLOTS];
+
+  MARE_DELETE_METHOD(timer_wheel(timer_wheel const&));
+  MARE_DELETE_METHOD(timer_wheel& operator=(timer_wheel const&));
+};
+
+/// Process-wide timer thread driving a timer_wheel.
+///
+/// The thread starts with the first timer. It sleeps until the next tick
+/// at which the wheel has work, and parks on _cv without a timeout while
+/// the wheel is empty. Expired entries are detached from the wheel under
+/// _mutex and their callbacks run as one batch after _mutex is released,
+/// so launching the tasks never delays schedule() callers, and periodic
+/// entries are refiled together once the batch is done.
+class timer_service {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  static timer_service& instance()
+  {
+    static timer_service s_service;
+    return s_service;
+  }
+
+  /// Runs cb once the deadline has passed. If period is nonzero and cb
+  /// returns true, cb runs again every period after the deadline.
+  template<typename Duration>
+  void schedule(clock::time_point const& deadline, Duration const& period,
+                timer_wheel::callback cb)
+  {
+    timer_wheel::entry* e = new timer_wheel::entry(to_ticks(deadline),
+                                                   ticks_ceil(period),
+                                                   std::move(cb));
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_thread.joinable())
+      _thread = std::thread(&timer_service::run, this);
+    _wheel.insert(e);
+    if (e->_deadline < _wakeup)
+      _cv.notify_one();
+  }
+
+  ~timer_service()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+      _cv.notify_one();
+    }
+    if (_thread.joinable())
+      _thread.join();
+  }
+
+private:
+  static const timer_wheel::tick_t PARKED = ~timer_wheel::tick_t(0);
+
+  timer_service() :
+    _epoch(clock::now()),
+    _mutex(),
+    _cv(),
+    _wheel(),
+    _wakeup(PARKED),
+    _stop(false),
+    _thread() { }
+
+  /// Rounds up, so that timers never fire early.
+  template<typename Duration>
+  static timer_wheel::tick_t ticks_ceil(Duration const& d)
+  {
+    auto t = std::chrono::duration_cast<timer_wheel::tick_duration>(d);
+    if (t < d)
+      ++t;
+    return t.count() < 0 ? 0 : static_cast<timer_wheel::tick_t>(t.count());
+  }
+
+  timer_wheel::tick_t to_ticks(clock::time_point const& tp) const
+  {
+    return ticks_ceil(tp - _epoch);
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+      if (_wheel.empty()) {
+        _wakeup = PARKED;
+        _cv.wait(lock);
+        continue;
+      }
+
+      auto now = std::chrono::duration_cast<timer_wheel::tick_duration>(
+                   clock::now() - _epoch).count();
+      timer_wheel::entry* expired =
+        _wheel.advance(static_cast<timer_wheel::tick_t>(now));
+      if (expired == nullptr) {
+        _wakeup = _wheel.next_event();
+        _cv.wait_until(lock, _epoch + timer_wheel::tick_duration(_wakeup));
+        continue;
+      }
+
+      _wakeup = _wheel.now();
+      lock.unlock();
+      timer_wheel::entry* rearm = nullptr;
+      while (expired != nullptr) {
+        timer_wheel::entry* e = expired;
+        expired = e->_next;
+        if (e->_callback() && e->_period != 0) {
+          e->_next = rearm;
+          rearm = e;
+        } else {
+          delete e;
+        }
+      }
+      lock.lock();
+      while (rearm != nullptr) {
+        timer_wheel::entry* e = rearm;
+        rearm = e->_next;
+        // Fixed rate; periods the thread fell behind on are skipped.
+        e->_deadline += e->_period;
+        if (e->_deadline <= _wheel.now())
+          e->_deadline += (_wheel.now() - e->_deadline) / e->_period * e->_period
+                          + e->_period;
+        _wheel.insert(e);
+      }
+    }
+  }
+
+  clock::time_point const _epoch;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  timer_wheel _wheel;
+  /// Tick the thread sleeps until; PARKED while the wheel is empty.
+  timer_wheel::tick_t _wakeup;
+  bool _stop;
+  std::thread _thread;
+
+  MARE_DELETE_METHOD(timer_service(timer_service const&));
+  MARE_DELETE_METHOD(timer_service& operator=(timer_service const&));
+};
+
+} //namespace internal
+
+} //namespace mare
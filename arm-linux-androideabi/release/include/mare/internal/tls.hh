@@ -16,8 +16,15 @@
 
 #include <stdint.h>
 
+#include <mare/internal/macros.hh>
 #include <mare/internal/tlsptr.hh>
 
+// Bionic's __thread support varies across NDK versions, so Android keeps
+// using pthread_getspecific only.
+#if defined(__GNUC__) && !defined(__ANDROID__)
+#define MARE_HAVE_TLS_INFO_CACHE 1
+#endif
+
 namespace mare {
 namespace internal {
 
@@ -68,15 +75,66 @@ info* init();
 void error(std::string msg, const char* filename, int lineno,
            const char* funcname);
 
+#ifdef MARE_HAVE_TLS_INFO_CACHE
+// pthread_getspecific is a call into libc, whereas native TLS is a load
+// off the thread pointer, so get() caches the info of the calling thread
+// in native TLS. The info is deleted by the pthread key destructor when
+// the thread exits. thread_local destructors run before the pthread key
+// destructors, so the guard below clears the cache, and keeps it
+// disabled, before the info goes away.
+class info_cache {
+public:
+  static info* get() {
+    return cached();
+  }
+
+  static void set(info* ti) {
+    if (exiting())
+      return;
+    static thread_local guard s_guard;
+    MARE_UNUSED(s_guard);
+    cached() = ti;
+  }
+
+private:
+  struct guard {
+    ~guard() {
+      cached() = nullptr;
+      exiting() = true;
+    }
+  };
+
+  static info*& cached() {
+    static __thread info* s_info = nullptr;
+    return s_info;
+  }
+
+  static bool& exiting() {
+    static __thread bool s_exiting = false;
+    return s_exiting;
+  }
+};
+#endif // MARE_HAVE_TLS_INFO_CACHE
+
 // This will get you the pointer so you can use it locally
 inline info*
 get()
 {
+#ifdef MARE_HAVE_TLS_INFO_CACHE
+  if (auto ti = info_cache::get())
+    return ti;
+  auto ti = g_tls_info.get();
+  if (!ti)
+    ti = init();
+  info_cache::set(ti);
+  return ti;
+#else
   auto ti = g_tls_info.get();
   if (ti)
     return ti;
 
   return init();
+#endif
 }
 
 
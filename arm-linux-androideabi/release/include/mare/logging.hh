@@ -0,0 +1,122 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file logging.hh */
+#pragma once
+
+#include <mare/internal/log/log.hh>
+
+namespace mare {
+
+// The logging namespace includes methods to switch MARE loggers on
+// and off at runtime.
+namespace logging {
+
+/** @addtogroup logging
+@{ */
+/**
+    Selects the loggers that receive events.
+
+    The event counter, pfor and trace loggers are compiled in unless
+    MARE_NO_RUNTIME_LOGGING is defined, but stay off until they are
+    selected here, by mare::tracing::start(), or through the
+    MARE_LOGGERS environment variable, which mare::runtime::init()
+    reads. The in-memory and ftrace loggers need a library built for
+    them and are only available if their MARE_USE_* macro is defined.
+
+    While logging is stopped, which is the default, every event costs
+    a single load and a branch.
+
+    For example, running a program with MARE_LOGGERS=trace writes a
+    trace of the program to mare_trace.json, or to MARE_TRACE_FILE if
+    it is set, when the program exits.
+
+    @param names Comma-separated list of logger names: "event_counter",
+    "pfor", "trace", "imlogger" and "ftrace". "all" selects every
+    compiled-in logger, "none" selects none.
+
+    @return
+    true -- All names were known.\n
+    false -- Some name is unknown or the logger is not compiled in.
+    The other names are selected anyway.
+*/
+inline bool set_loggers(const char* names)
+{
+  return internal::log::loggers::set_loggers(names);
+}
+
+/**
+    Selects the classes of events that are logged.
+
+    The classes are "group", "task", "refcount", "sdf", "pfor" and
+    "runtime". By default, all of them are logged. The
+    MARE_LOG_EVENTS environment variable, which mare::runtime::init()
+    reads, sets them as well.
+
+    @param names Comma-separated list of event classes, "all" or "none".
+
+    @return
+    true -- All names were known.\n
+    false -- Some name is unknown. The other classes are selected
+    anyway.
+*/
+inline bool set_event_classes(const char* names)
+{
+  return internal::log::loggers::set_event_classes(names);
+}
+
+/**
+    Starts or resumes logging. Only the selected loggers receive
+    events.
+*/
+inline void start()
+{
+  internal::log::loggers::init();
+  internal::log::loggers::resume();
+}
+
+/**
+    Stops logging. The loggers keep what they have logged so far.
+*/
+inline void stop()
+{
+  internal::log::loggers::pause();
+}
+
+/**
+    Checks whether events are being logged.
+
+    @return
+    true -- Logging was started and is not stopped.\n
+    false -- Otherwise.
+*/
+inline bool is_active()
+{
+  return internal::log::loggers::is_active();
+}
+
+/**
+    Asks the selected loggers to output their results, e.g., the
+    event counter logger prints its counts and the trace logger writes
+    its trace file.
+*/
+inline void dump()
+{
+  internal::log::loggers::dump();
+}
+/** @} */ /* end_addtogroup logging */
+
+} //namespace logging
+
+} //namespace mare
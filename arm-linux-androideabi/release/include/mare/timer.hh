@@ -0,0 +1,154 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file timer.hh */
+#pragma once
+
+#include <chrono>
+#include <type_traits>
+
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/runtime.hh>
+#include <mare/internal/timerwheel.hh>
+
+namespace mare
+{
+
+/** @addtogroup execution
+@{ */
+/**
+    Creates a new task and launches it into a group once a delay has
+    passed.
+
+    The task is created and added to <tt>group</tt> right away, but it
+    is only launched after <tt>delay</tt>, by a timer thread that MARE
+    starts on the first call to mare::launch_after or
+    mare::launch_every. No worker thread is tied up while the delay
+    runs. Timers have a resolution of one millisecond and never fire
+    early.
+
+    Since the task belongs to <tt>group</tt> from the start,
+    <tt>mare::wait_for(group)</tt> also waits for delayed tasks that
+    have not been launched yet, and <tt>mare::cancel(group)</tt>
+    cancels them before they run.
+
+    Timers that expire after the MARE runtime has been shut down are
+    discarded.
+
+    @param group Pointer to group.
+    @param delay Time to wait before launching the task.
+    @param body  Task body.
+
+    @return Pointer to the new task.
+
+    @throws api_exception If group points to null.
+
+    @sa mare::launch_every(std::chrono::duration<Rep, Period> const&,
+                           Body&&)
+*/
+template<typename Rep, typename Period, typename Body>
+task_ptr launch_after(group_ptr const& group,
+                      std::chrono::duration<Rep, Period> const& delay,
+                      Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+  auto t = create_task(std::forward<Body>(body));
+  join_group(group, t);
+  internal::timer_service::instance().schedule(
+      std::chrono::steady_clock::now() + delay,
+      std::chrono::milliseconds(0),
+      [t] {
+        if (internal::runtime_available())
+          launch(t);
+        return false;
+      });
+  return t;
+}
+
+/**
+    Launches a new task into a group every period, until the group is
+    canceled.
+
+    The first task is launched one <tt>period</tt> after the call.
+    Launch times are computed from the time of the call, so they do not
+    drift when tasks are delayed; if the timer thread falls behind, the
+    missed launches are collapsed into one. A new task is launched even
+    if the previous one is still running.
+
+    <tt>mare::cancel(group)</tt> stops the launches. Tasks only join
+    <tt>group</tt> when they are launched, so
+    <tt>mare::wait_for(group)</tt> does not wait for future periods.
+
+    @param group  Pointer to group.
+    @param period Time between two launches.
+    @param body   Task body. It is copied for every launch.
+
+    @throws api_exception If group points to null or period is not
+    positive.
+
+    @sa mare::launch_every(std::chrono::duration<Rep, Period> const&,
+                           Body&&)
+*/
+template<typename Rep, typename Period, typename Body>
+void launch_every(group_ptr const& group,
+                  std::chrono::duration<Rep, Period> const& period,
+                  Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+  MARE_API_ASSERT(period.count() > 0,
+                  "period must be positive");
+  typedef typename std::decay<Body>::type body_type;
+  body_type b(std::forward<Body>(body));
+  internal::timer_service::instance().schedule(
+      std::chrono::steady_clock::now() + period,
+      period,
+      [group, b] {
+        if (!internal::runtime_available() || canceled(group))
+          return false;
+        launch(group, b);
+        return true;
+      });
+}
+
+/**
+    Launches a new task every period, into a new group.
+
+    See mare::launch_every(group_ptr const&,
+                           std::chrono::duration<Rep, Period> const&,
+                           Body&&).
+
+    @param period Time between two launches.
+    @param body   Task body. It is copied for every launch.
+
+    @return Pointer to the group the tasks are launched into. Cancel it
+    to stop the launches.
+
+    @throws api_exception If period is not positive.
+
+    @par Example
+    @includelineno examples/timers.cc
+*/
+template<typename Rep, typename Period, typename Body>
+group_ptr launch_every(std::chrono::duration<Rep, Period> const& period,
+                       Body&& body)
+{
+  auto g = create_group("launch_every");
+  launch_every(g, period, std::forward<Body>(body));
+  return g;
+}
+/** @} */ /* end_addtogroup execution */
+
+} //namespace mare
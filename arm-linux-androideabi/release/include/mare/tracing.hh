@@ -0,0 +1,110 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file tracing.hh */
+#pragma once
+
+#include <cstddef>
+
+#include <mare/internal/log/log.hh>
+
+namespace mare {
+
+// The tracing namespace includes methods to record MARE events and
+// write them out in the Chrome trace event format.
+namespace tracing {
+
+/** @addtogroup tracing
+@{ */
+/**
+    Starts or resumes recording of events.
+
+    Every thread that logs an event records it in a ring of its own,
+    which keeps the most recent events_per_thread events. Switches on
+    the trace logger in addition to the loggers already selected with
+    mare::logging::set_loggers(), and starts logging. Does nothing if
+    MARE_NO_RUNTIME_LOGGING is defined.
+
+    Only events fired from the MARE headers are recorded: task
+    creation, dependencies and execution, group creation, and the
+    firing of SDF nodes.
+
+    @param events_per_thread Capacity of the ring of each thread,
+    rounded up to a power of two. Rings that already exist keep their
+    capacity.
+*/
+inline void
+start(size_t events_per_thread =
+      internal::log::trace_logger::default_ring_size)
+{
+  internal::log::trace_logger::set_ring_size(events_per_thread);
+  internal::log::loggers::enable_logger(
+    internal::log::trace_logger::get_name());
+  internal::log::loggers::init();
+  internal::log::loggers::resume();
+}
+
+/**
+    Stops logging, which also stops recording of events. The recorded
+    events are kept.
+*/
+inline void stop()
+{
+  internal::log::loggers::pause();
+}
+
+/**
+    Writes the recorded events to a JSON file that chrome://tracing
+    and Perfetto can open.
+
+    Threads may keep recording while the file is written; events that
+    are overwritten in the meantime are left out.
+
+    @param path Name of the file to write.
+
+    @return
+    true -- The file was written.\n
+    false -- The file could not be written or the trace logger is not
+    compiled in.
+*/
+inline bool dump(const char* path)
+{
+  if (!internal::log::trace_logger::enabled::value)
+    return false;
+  return internal::log::trace_logger::write_trace(path);
+}
+
+/**
+    Writes the recorded events to path every time the process receives
+    signal signo, e.g., SIGUSR1.
+
+    The signal handler only wakes up a helper thread, which then writes
+    the file, so a long-running program can be traced without stopping
+    it. Does nothing if the trace logger is not compiled in.
+
+    @param signo Signal that triggers the dump.
+    @param path Name of the file to write.
+*/
+inline void dump_on_signal(int signo, const char* path)
+{
+  if (!internal::log::trace_logger::enabled::value)
+    return;
+  internal::log::trace_logger::set_path(path);
+  internal::log::trace_logger::dump_on_signal(signo);
+}
+/** @} */ /* end_addtogroup tracing */
+
+} //namespace tracing
+
+} //namespace mare
@@ -0,0 +1,85 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <chrono>
+#include <vector>
+
+#include <mare/barrier.hh>
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::barrier, and
+//  2. compare the latency of mare::barrier, a central sense-reversing
+//     barrier, with that of the opt-in mare::tree_barrier, a
+//     combining-tree barrier, for 2 to 128 participants.
+//
+//  Each participant runs num_rounds rounds. In each round it records
+//  the round it is in, waits on the barrier, and checks that every
+//  other participant has reached the same round.
+
+const std::size_t num_rounds = 200;
+
+// Returns the average time per barrier episode, in microseconds
+template<typename Barrier>
+double
+run(std::size_t num_tasks)
+{
+  Barrier b(num_tasks);
+  std::vector<std::size_t> rounds(num_tasks, 0);
+
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_tasks; t++) {
+    mare::launch(g, [&b, &rounds, t, num_tasks] {
+        for (std::size_t r = 1; r <= num_rounds; r++) {
+          rounds[t] = r;
+          b.wait();
+          for (std::size_t other = 0; other < num_tasks; other++)
+            if (rounds[other] < r)
+              MARE_FATAL("Task %zu passed the barrier in round %zu, but "
+                         "task %zu is still in round %zu",
+                         t, r, other, rounds[other]);
+          b.wait();
+        }
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  double us = std::chrono::duration<double, std::micro>(end - start).count();
+  return us / (2 * num_rounds);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("tasks          barrier   tree_barrier");
+  for (std::size_t num_tasks = 2; num_tasks <= 128; num_tasks *= 2) {
+    double sense = run<mare::barrier>(num_tasks);
+    double tree = run<mare::tree_barrier>(num_tasks);
+    MARE_LLOG("%-6zu %15.2f %14.2f us/barrier",
+              num_tasks, sense, tree);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
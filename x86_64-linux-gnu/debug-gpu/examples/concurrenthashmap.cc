@@ -0,0 +1,172 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/concurrenthashmap.hh>
+#include <mare/mutex.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::concurrent_hash_map from many tasks,
+//     and
+//  2. compare its throughput against a std::unordered_map protected by a
+//     mare::mutex, for a read-mostly and a write-heavy workload, with
+//     both hazard pointer and epoch-based reclamation.
+//
+//  Each benchmark prefills the map with num_keys / 2 keys and launches
+//  num_tasks tasks. Each task performs num_ops operations on random keys
+//  in [0, num_keys): a lookup, or, with probability write_percent, an
+//  insert or an erase. The concurrent map starts out with few buckets,
+//  so the write-heavy workload also exercises its incremental resize.
+
+const std::size_t num_keys  = 1 << 16;
+const std::size_t num_tasks = 8;
+const std::size_t num_ops   = 1 << 17;
+
+// The status quo: a std::unordered_map protected by a mare::mutex
+class locked_map {
+public:
+  locked_map() : _mutex(), _map() {}
+
+  bool find(std::size_t key, std::size_t& value) {
+    std::lock_guard<mare::mutex> lock(_mutex);
+    auto it = _map.find(key);
+    if (it == _map.end())
+      return false;
+    value = it->second;
+    return true;
+  }
+
+  bool insert(std::size_t key, std::size_t value) {
+    std::lock_guard<mare::mutex> lock(_mutex);
+    return _map.insert(std::make_pair(key, value)).second;
+  }
+
+  bool erase(std::size_t key) {
+    std::lock_guard<mare::mutex> lock(_mutex);
+    return _map.erase(key) != 0;
+  }
+
+private:
+  mare::mutex _mutex;
+  std::unordered_map<std::size_t, std::size_t> _map;
+};
+
+typedef mare::concurrent_hash_map<std::size_t, std::size_t> hp_map;
+
+typedef mare::concurrent_hash_map<std::size_t,
+                                  std::size_t,
+                                  std::hash<std::size_t>,
+                                  std::equal_to<std::size_t>,
+                                  mare::epoch_based_reclamation> epoch_map;
+
+// Small xorshift generator, so tasks do not contend on a shared one
+struct random_keys {
+  explicit random_keys(std::size_t seed) : _state(seed * 2654435761u + 1) {}
+
+  std::size_t next() {
+    _state ^= _state << 13;
+    _state ^= _state >> 7;
+    _state ^= _state << 17;
+    return _state;
+  }
+
+  std::size_t _state;
+};
+
+// Returns the throughput, in operations/s
+template<typename Map>
+double
+run(Map& map, std::size_t write_percent)
+{
+  for (std::size_t k = 0; k < num_keys; k += 2)
+    map.insert(k, 3 * k);
+
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_tasks; t++) {
+    mare::launch(g, [&map, t, write_percent] {
+        random_keys keys(t);
+        for (std::size_t i = 0; i < num_ops; i++) {
+          std::size_t r = keys.next();
+          std::size_t key = (r >> 8) % num_keys;
+          if (r % 100 < write_percent) {
+            if (r & 128)
+              map.insert(key, 3 * key);
+            else
+              map.erase(key);
+          } else {
+            std::size_t value;
+            if (map.find(key, value))
+              assert(value == 3 * key);
+            MARE_UNUSED(value);
+          }
+        }
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_tasks * num_ops) / seconds;
+}
+
+void
+report(char const* workload, std::size_t write_percent)
+{
+  double locked;
+  {
+    locked_map map;
+    locked = run(map, write_percent);
+  }
+
+  double hp;
+  {
+    hp_map map(64);
+    hp = run(map, write_percent);
+  }
+
+  double epoch;
+  {
+    epoch_map map(64);
+    epoch = run(map, write_percent);
+  }
+
+  MARE_LLOG("%-12s %14.1f %14.1f %14.1f ops/s (%.2fx, %.2fx)",
+            workload, locked, hp, epoch, hp / locked, epoch / locked);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("%-12s %14s %14s %14s",
+            "workload", "locked_map", "hp_map", "epoch_map");
+  report("read-mostly", 5);
+  report("write-heavy", 50);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+
+#include <mare/internal/debug.hh>
+#include <mare/fiber.hh>
+#include <mare/mare.h>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::launch_fiber, and
+//  2. compare tasks and fibers on workloads that spend most of their
+//     time waiting for other tasks.
+//
+//  chain: num_waiters bodies each launch a child task and wait for it,
+//         num_waits times in a row.
+//  tree:  every body above the leaves launches two children and waits
+//         for both, so every level of the tree waits on the next one.
+//
+//  A task that waits keeps its worker until the wait returns, while a
+//  fiber is suspended and its worker runs the children in the meantime.
+
+const std::size_t num_waiters = 256;
+const std::size_t num_waits = 64;
+const std::size_t tree_depth = 12;
+
+std::atomic<std::size_t> s_leaves;
+
+struct as_task {
+  template<typename Body>
+  static void launch(mare::group_ptr const& g, Body&& body)
+  {
+    mare::launch(g, std::forward<Body>(body));
+  }
+  static const char* name() { return "tasks"; }
+};
+
+struct as_fiber {
+  template<typename Body>
+  static void launch(mare::group_ptr const& g, Body&& body)
+  {
+    mare::launch_fiber(g, std::forward<Body>(body));
+  }
+  static const char* name() { return "fibers"; }
+};
+
+template<typename Mode>
+double
+chain()
+{
+  std::atomic<std::size_t> done(0);
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t w = 0; w < num_waiters; w++) {
+    Mode::launch(g, [&done] {
+        for (std::size_t i = 0; i < num_waits; i++) {
+          auto child = mare::create_task([&done] { done++; });
+          mare::launch(child);
+          mare::wait_for(child);
+        }
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  assert(done == num_waiters * num_waits);
+  MARE_UNUSED(done);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+template<typename Mode>
+void
+node(std::size_t depth)
+{
+  if (depth == 0) {
+    s_leaves++;
+    return;
+  }
+  auto children = mare::create_group();
+  for (int c = 0; c < 2; c++)
+    Mode::launch(children, [depth] {
+        node<Mode>(depth - 1);
+      });
+  mare::wait_for(children);
+}
+
+template<typename Mode>
+double
+tree()
+{
+  s_leaves = 0;
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  Mode::launch(g, [] { node<Mode>(tree_depth); });
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  assert(s_leaves == std::size_t(1) << tree_depth);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+template<typename Mode>
+void
+run()
+{
+  double c = chain<Mode>();
+  double t = tree<Mode>();
+  MARE_LLOG("%-7s %10.4f s %10.4f s", Mode::name(), c, t);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("mode         chain       tree");
+  run<as_task>();
+  run<as_fiber>();
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstddef>
+#include <cstdio>
+
+#include <signal.h>
+
+#include <mare/mare.h>
+#include <mare/patterns.hh>
+#include <mare/sdf.hh>
+#include <mare/tracing.hh>
+
+///////////////
+//
+//  Goal is to
+//  record a trace of a few tasks, a pfor_each and an SDF pipeline,
+//  and write it out as mare_trace.json, which can be opened with
+//  chrome://tracing or https://ui.perfetto.dev.
+//
+//  Each thread records its events in a ring of its own, without
+//  locks, so tracing barely disturbs the program being traced. The
+//  trace is written explicitly with mare::tracing::dump(); sending
+//  SIGUSR1 to the process writes it as well.
+
+const std::size_t num_tasks = 32;
+const std::size_t num_iterations = 16;
+
+static void
+spin(std::size_t n)
+{
+  for (std::size_t i = 0; i < n; i++)
+    asm volatile("" ::: "memory");
+}
+
+void produce(int& a) {
+  static int x = 0;
+  spin(20000);
+  a = x++;
+}
+
+void transform(int& a, int& b) {
+  spin(40000);
+  b = a * 2;
+}
+
+void consume(int&) {
+  spin(20000);
+}
+
+int main() {
+  mare::runtime::init();
+
+  mare::tracing::start();
+  mare::tracing::dump_on_signal(SIGUSR1, "mare_trace.json");
+
+  // Tasks with dependencies: each task of the chain runs after the
+  // previous one, all of them run in group g.
+  auto g = mare::create_group("traced");
+  auto prev = mare::create_task([] { spin(100000); });
+  mare::launch(g, prev);
+  for (std::size_t i = 1; i < num_tasks; i++) {
+    auto t = mare::create_task([] { spin(100000); });
+    prev >> t;
+    mare::launch(g, t);
+    prev = t;
+  }
+  mare::wait_for(g);
+
+  mare::pfor_each(size_t(0), num_tasks * 8, [](size_t) {
+      spin(50000);
+    });
+
+  mare::data_channel<int> dc1, dc2;
+  mare::sdf_graph_ptr sdf = mare::create_sdf_graph();
+  mare::create_sdf_node(sdf, produce, mare::with_outputs(dc1));
+  mare::create_sdf_node(sdf, transform, mare::with_inputs(dc1),
+                                        mare::with_outputs(dc2));
+  mare::create_sdf_node(sdf, consume, mare::with_inputs(dc2));
+  mare::launch_and_wait(sdf, num_iterations);
+  mare::destroy_sdf_graph(sdf);
+
+  mare::tracing::stop();
+
+  if (mare::tracing::dump("mare_trace.json"))
+    MARE_LLOG("Trace written to mare_trace.json");
+  else
+    MARE_LLOG("Unable to write mare_trace.json");
+
+  mare::runtime::shutdown();
+  return 0;
+}
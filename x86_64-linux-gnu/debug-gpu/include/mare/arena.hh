@@ -0,0 +1,424 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file arena.hh */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/arena.hh>
+
+namespace mare {
+
+/** @addtogroup arena
+@{ */
+/**
+    Bump allocator for objects that die together.
+
+    An arena hands out memory by bumping an offset into a chunk of
+    memory, and never frees single allocations: all its memory is
+    reclaimed at once by <tt>reset()</tt> or by its destructor. This
+    suits the many short-lived objects that the tasks of one request
+    allocate, which would otherwise cost a malloc/free pair each.
+
+    Chunks come from a per-thread cache, so that arenas that are reset
+    and filled again reuse memory instead of going back to malloc.
+
+    <tt>allocate()</tt> may be called concurrently, e.g., by all the
+    tasks of a group. <tt>reset()</tt> must not run concurrently with
+    any other member function.
+
+    An arena declared in a task body is task-scoped. See
+    mare::group_arena for arenas bound to a group.
+
+    @par Example
+    @includelineno examples/arena.cc
+*/
+class arena {
+public:
+  arena() :
+    _current(nullptr),
+    _mutex(),
+    _chunks(nullptr) {
+  }
+
+  ~arena() {
+    reset();
+  }
+
+  MARE_DELETE_METHOD(arena(arena const&));
+  MARE_DELETE_METHOD(arena& operator=(arena const&));
+
+  /**
+      Allocates memory from the arena.
+
+      @param size  Number of bytes.
+      @param align Alignment; must be a power of two.
+
+      @return Pointer to the memory, valid until the arena is reset or
+      destroyed.
+
+      @throws std::bad_alloc If no memory is available.
+  */
+  void* allocate(std::size_t size,
+                 std::size_t align = alignof(std::max_align_t)) {
+    MARE_API_ASSERT(align != 0 && (align & (align - 1)) == 0,
+                    "arena alignment must be a power of two");
+    if (align > large_threshold || size > large_threshold - align)
+      return allocate_large(size, align);
+    while (true) {
+      internal::arena_chunk* c = _current.load(std::memory_order_acquire);
+      if (c != nullptr) {
+        if (void* p = c->try_allocate(size, align))
+          return p;
+      }
+      refill(c);
+    }
+  }
+
+  /**
+      Constructs an object in the arena.
+
+      @note1 The destructor of the object is not invoked when the arena
+      is reset, so T should not own resources other than arena memory.
+
+      @param args Arguments of the constructor of T.
+
+      @return Pointer to the new object.
+  */
+  template<typename T, typename... Args>
+  T* create(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T)))
+      T(std::forward<Args>(args)...);
+  }
+
+  /**
+      Reclaims all the memory of the arena at once. Standard chunks go
+      back to the chunk cache of the calling thread.
+  */
+  void reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    internal::arena_chunk* c = _chunks;
+    while (c != nullptr) {
+      internal::arena_chunk* next = c->_next;
+      internal::arena_chunk_cache::release(c);
+      c = next;
+    }
+    _chunks = nullptr;
+    _current.store(nullptr, std::memory_order_relaxed);
+  }
+
+private:
+  // Larger allocations get a chunk of their own, so that they neither
+  // waste the rest of the current chunk nor force a new one
+  static const std::size_t large_threshold =
+    internal::arena_chunk::standard_capacity() / 4;
+
+  // Replaces the current chunk unless another thread has already
+  // replaced seen
+  void refill(internal::arena_chunk* seen) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_current.load(std::memory_order_relaxed) != seen)
+      return;
+    internal::arena_chunk* c = internal::arena_chunk_cache::acquire();
+    c->_next = _chunks;
+    _chunks = c;
+    _current.store(c, std::memory_order_release);
+  }
+
+  void* allocate_large(std::size_t size, std::size_t align) {
+    if (size > std::numeric_limits<std::size_t>::max() - (align - 1))
+      throw std::bad_alloc();
+    internal::arena_chunk* c =
+      internal::arena_chunk_cache::acquire_large(size + align - 1);
+    void* p = c->try_allocate(size, align);
+    MARE_INTERNAL_ASSERT(p != nullptr, "large arena chunk is too small");
+    std::lock_guard<std::mutex> lock(_mutex);
+    c->_next = _chunks;
+    _chunks = c;
+    return p;
+  }
+
+  std::atomic<internal::arena_chunk*> _current;
+  std::mutex _mutex;
+  internal::arena_chunk* _chunks;   // all chunks, for reset()
+};
+
+/**
+   STL-compliant allocator that allocates from a mare::arena.
+   deallocate() does nothing; the memory is reclaimed when the arena is
+   reset or destroyed.
+   @tparam T Type of the element to allocate.
+*/
+
+// squelch GCC complaints about non-virtual destructor
+MARE_GCC_IGNORE_BEGIN("-Weffc++");
+
+template <class T>
+// Inherit construct(), destruct() etc.
+struct arena_allocator : public std::allocator<T>
+{
+
+MARE_GCC_IGNORE_END("-Weffc++");
+
+  typedef std::size_t size_type;
+  typedef T* pointer;
+  typedef T const* const_pointer;
+
+  // Allocators of different arenas are not interchangeable
+  typedef std::false_type is_always_equal;
+
+  //Defines an arena allocator suitable for allocating elements of type U.
+  template <class U>
+  struct rebind {
+    typedef arena_allocator<U> other;
+  };
+
+
+  //Constructs an allocator that allocates from a.
+  explicit arena_allocator(arena& a) throw() :
+    std::allocator<T>(), _arena(&a) {}
+
+
+  //Copy-constructs an allocator.
+  arena_allocator(const arena_allocator& other) throw() :
+    std::allocator<T>(other), _arena(other._arena) {}
+
+
+  //Convert-constructs an allocator.
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other) throw() :
+    std::allocator<T>(), _arena(other.get_arena()) {}
+
+
+  //Destroys an allocator.
+  ~arena_allocator() throw() {}
+
+
+  //Allocates n elements of type T from the arena.
+  pointer allocate(size_type n) {
+    return allocate(n, const_pointer(0));
+  }
+
+
+  //Allocates n elements of type T from the arena.
+  pointer allocate(size_type n, const_pointer) {
+    if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+      throw std::bad_alloc();
+    return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+
+  //Memory is reclaimed with the arena.
+  void deallocate(pointer, size_type) {}
+
+
+  //Returns the arena the allocator allocates from.
+  arena* get_arena() const { return _arena; }
+
+private:
+  arena* _arena;
+};
+
+
+/**
+   Checks whether two arena allocators are equal, i.e., whether they
+   allocate from the same arena.
+*/
+template <class T1, class T2>
+bool operator == (const arena_allocator<T1> & a,
+                  const arena_allocator<T2> & b)
+{
+  return a.get_arena() == b.get_arena();
+}
+
+
+/**
+   Checks whether two arena allocators allocate from different arenas.
+*/
+template <class T1, class T2>
+bool operator != (const arena_allocator<T1> & a,
+                  const arena_allocator<T2> & b)
+{
+  return a.get_arena() != b.get_arena();
+}
+/** @} */ /* end_addtogroup arena */
+
+namespace internal {
+
+/// Arenas bound to groups.
+///
+/// The group class has no room for per-group data, so the arenas are
+/// kept in a map from group to arena, as scoped storage would be. Each
+/// entry holds a reference to its group. Once that is the only
+/// reference left and the group is empty, nothing can launch tasks into
+/// the group or look up its arena anymore, so the entry is dropped and
+/// the chunks of the arena are recycled. The map is swept once the
+/// number of bind() calls since the last sweep reaches the number of
+/// entries left by that sweep, so that a sweep costs O(1) per bind()
+/// however many groups are alive, and a dead group is dropped at the
+/// latest that many lookups after it died. release() drops an entry
+/// right away.
+class group_arena_map {
+public:
+  static group_arena_map& get() {
+    // Never destroyed, so that tasks that run late can still use it
+    static group_arena_map* s_map = new group_arena_map();
+    return *s_map;
+  }
+
+  arena& bind(group* g) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (++_binds >= _sweep_after) {
+      sweep();
+      _binds = 0;
+      _sweep_after = std::max(min_sweep_after, _arenas.size());
+    }
+    auto it = _arenas.find(g);
+    if (it != _arenas.end())
+      return *it->second._arena;
+    entry& e = _arenas[g];
+    e._group = group_ptr(g);
+    e._arena.reset(new arena());
+    return *e._arena;
+  }
+
+  void release(group* g) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _arenas.erase(g);
+  }
+
+private:
+  static const std::size_t min_sweep_after = 16;
+
+  struct entry {
+    group_ptr _group;
+    std::unique_ptr<arena> _arena;
+
+    entry() : _group(), _arena() {}
+  };
+
+  group_arena_map() :
+    _mutex(),
+    _arenas(),
+    _binds(0),
+    _sweep_after(min_sweep_after) {
+  }
+
+  MARE_DELETE_METHOD(group_arena_map(group_arena_map const&));
+  MARE_DELETE_METHOD(group_arena_map& operator=(group_arena_map const&));
+
+  void sweep() {
+    for (auto it = _arenas.begin(); it != _arenas.end(); ) {
+      group_ptr const& g = it->second._group;
+      if (g.use_count() == 1 && c_ptr(g)->is_empty())
+        it = _arenas.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  std::mutex _mutex;
+  std::unordered_map<group*, entry> _arenas;
+  std::size_t _binds;         // bind() calls since the last sweep
+  std::size_t _sweep_after;
+};
+
+} //namespace internal
+
+/** @addtogroup arena
+@{ */
+/**
+    Returns the arena bound to a group, creating it on first use.
+
+    All the tasks of <tt>group</tt> can allocate from its arena, e.g.,
+    with a mare::arena_allocator. The memory remains valid as long as
+    the group is alive. The arena keeps the group alive too: once the
+    last other group_ptr to the group is gone and its tasks have
+    completed, the group and its arena are reclaimed by a later call to
+    <tt>group_arena()</tt>, at the latest after as many calls as there
+    are groups with arenas. Call mare::release_group_arena to reclaim
+    them right away. Groups that are reused, e.g., one group per worker
+    of a server, can reclaim the arena whenever they become empty by
+    calling <tt>group_arena(group).reset()</tt> after
+    <tt>mare::wait_for(group)</tt> has returned and before new tasks
+    are launched into the group.
+
+    The lookup takes a lock, so tasks should look up the arena once and
+    keep the reference.
+
+    @param group Pointer to group.
+
+    @return Arena bound to the group.
+
+    @throws api_exception If group points to null.
+*/
+inline arena& group_arena(group_ptr const& group)
+{
+  auto g_ptr = internal::c_ptr(group);
+  MARE_API_ASSERT(g_ptr, "null group_ptr");
+  return internal::group_arena_map::get().bind(g_ptr);
+}
+
+/**
+    Returns the arena bound to the group of the calling task. For a task
+    launched into several groups, this is the group they intersect in.
+
+    @return Arena bound to the group of the calling task.
+
+    @throws api_exception If not called from a task that belongs to a
+    group.
+*/
+inline arena& group_arena()
+{
+  auto t = internal::current_task();
+  MARE_API_ASSERT(t != nullptr, "group_arena() called outside of a task");
+  auto g_ptr = t->get_group();
+  MARE_API_ASSERT(g_ptr != nullptr, "the calling task is not in a group");
+  return internal::group_arena_map::get().bind(g_ptr);
+}
+
+/**
+    Reclaims the arena bound to a group right away.
+
+    Call this once no task uses memory from the arena anymore, e.g.,
+    after <tt>mare::wait_for(group)</tt> has returned. The arena no
+    longer keeps the group alive. A later call to
+    <tt>group_arena(group)</tt> binds a new arena.
+
+    @param group Pointer to group.
+
+    @throws api_exception If group points to null.
+*/
+inline void release_group_arena(group_ptr const& group)
+{
+  auto g_ptr = internal::c_ptr(group);
+  MARE_API_ASSERT(g_ptr, "null group_ptr");
+  internal::group_arena_map::get().release(g_ptr);
+}
+/** @} */ /* end_addtogroup arena */
+
+} //namespace mare
@@ -0,0 +1,306 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include <mare/exceptions.hh>
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/nodecache.hh>
+#include <mare/internal/taskfactory.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Allocator of coroutine frames.
+///
+/// Frames are rounded up to one of a few size classes, each backed by a
+/// node_cache, so that a worker that keeps starting coroutines reuses the
+/// frames it or other workers freed without taking a lock. Larger frames
+/// come from operator new.
+class coro_frame_allocator {
+public:
+  static void* allocate(std::size_t size)
+  {
+    if (size <= 128)
+      return cache<128>::allocate(sizeof(block<128>));
+    if (size <= 256)
+      return cache<256>::allocate(sizeof(block<256>));
+    if (size <= 512)
+      return cache<512>::allocate(sizeof(block<512>));
+    if (size <= 1024)
+      return cache<1024>::allocate(sizeof(block<1024>));
+    return ::operator new(size);
+  }
+
+  static void deallocate(void* p, std::size_t size)
+  {
+    if (size <= 128)
+      cache<128>::deallocate(p);
+    else if (size <= 256)
+      cache<256>::deallocate(p);
+    else if (size <= 512)
+      cache<512>::deallocate(p);
+    else if (size <= 1024)
+      cache<1024>::deallocate(p);
+    else
+      ::operator delete(p);
+  }
+
+private:
+  template<std::size_t N>
+  struct block {
+    alignas(std::max_align_t) char _bytes[N];
+  };
+
+  template<std::size_t N>
+  using cache = node_cache< block<N> >;
+};
+
+/// Resumes h from a new stub task, once pred has completed or has been
+/// canceled if pred is not null. Stubs are not cancelable, so that h is
+/// resumed in any case.
+inline void
+resume_on_worker(std::coroutine_handle<> h, task* pred = nullptr)
+{
+  launch_stub_task([h] { h.resume(); }, pred);
+}
+
+/// Parts of the promise of coro_task<T> that do not depend on T.
+class coro_promise_base {
+public:
+  static void* operator new(std::size_t size)
+  {
+    return coro_frame_allocator::allocate(size);
+  }
+
+  static void operator delete(void* p, std::size_t size)
+  {
+    coro_frame_allocator::deallocate(p, size);
+  }
+
+  /// Coroutines are lazy: they start when awaited or launched.
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  /// Transfers control to the awaiting coroutine, if any. A launched
+  /// coroutine launches _done instead. The frame may be destroyed as
+  /// soon as _done is launched, so nothing in it is touched afterwards.
+  struct final_awaiter {
+    bool await_ready() noexcept { return false; }
+
+    template<typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> h) noexcept
+    {
+      coro_promise_base& p = h.promise();
+      std::coroutine_handle<> continuation = p._continuation;
+      task_ptr done = std::move(p._done);
+      if (done != nullptr)
+        launch(done);
+      if (continuation)
+        return continuation;
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept { }
+  };
+
+  final_awaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception()
+  {
+    _exception = std::current_exception();
+  }
+
+  std::coroutine_handle<> _continuation;
+  task_ptr _done;
+
+protected:
+  void rethrow_if_failed() const
+  {
+    if (_exception)
+      std::rethrow_exception(_exception);
+  }
+
+  std::exception_ptr _exception;
+};
+
+template<typename T>
+class coro_promise : public coro_promise_base {
+public:
+  template<typename U>
+  void return_value(U&& value)
+  {
+    _value.emplace(std::forward<U>(value));
+  }
+
+  T result()
+  {
+    rethrow_if_failed();
+    return std::move(*_value);
+  }
+
+private:
+  std::optional<T> _value;
+};
+
+template<>
+class coro_promise<void> : public coro_promise_base {
+public:
+  void return_void() { }
+
+  void result()
+  {
+    rethrow_if_failed();
+  }
+};
+
+/// co_await on a task_ptr: resumes the coroutine from a successor of the
+/// task.
+class task_awaiter {
+public:
+  explicit task_awaiter(task* t) : _task(t) { }
+
+  bool await_ready() const
+  {
+    return _task->get_state().is_done();
+  }
+
+  void await_suspend(std::coroutine_handle<> h) const
+  {
+    resume_on_worker(h, _task);
+  }
+
+  void await_resume() const { }
+
+private:
+  task* _task;
+};
+
+/// Polls cond() from a yielding stub task, and resumes h on the first
+/// poll that returns true. Used where there is no completion to chain a
+/// successor to.
+template<typename Cond>
+class poll_stub {
+public:
+  poll_stub(Cond const& cond, std::coroutine_handle<> h) :
+    _cond(cond),
+    _h(h) { }
+
+  void operator()() const
+  {
+    if (_cond())
+      _h.resume();
+    else
+      launch_stub_task(*this);
+  }
+
+private:
+  Cond _cond;
+  std::coroutine_handle<> _h;
+};
+
+template<typename Cond>
+void
+resume_when(Cond const& cond, std::coroutine_handle<> h)
+{
+  launch_stub_task(poll_stub<Cond>(cond, h));
+}
+
+/// co_await on a group_ptr.
+class group_awaiter {
+public:
+  explicit group_awaiter(group_ptr const& g) : _group(g) { }
+
+  bool await_ready() const
+  {
+    return c_ptr(_group)->is_empty();
+  }
+
+  void await_suspend(std::coroutine_handle<> h) const
+  {
+    group* g = c_ptr(_group);
+    resume_when([g] { return g->is_empty(); }, h);
+  }
+
+  void await_resume() const { }
+
+private:
+  group_ptr _group;
+};
+
+/// co_await mare::lock_async(m): resumes the coroutine once it has
+/// locked m.
+template<typename Mutex>
+class lock_awaiter {
+public:
+  explicit lock_awaiter(Mutex& m) : _mutex(&m) { }
+
+  bool await_ready() const
+  {
+    return _mutex->try_lock();
+  }
+
+  void await_suspend(std::coroutine_handle<> h) const
+  {
+    Mutex* m = _mutex;
+    resume_when([m] { return m->try_lock(); }, h);
+  }
+
+  std::unique_lock<Mutex> await_resume() const
+  {
+    return std::unique_lock<Mutex>(*_mutex, std::adopt_lock);
+  }
+
+private:
+  Mutex* _mutex;
+};
+
+// Found by argument-dependent lookup, since task_ptr and group_ptr are
+// declared in this namespace.
+
+inline task_awaiter
+operator co_await(task_ptr const& t)
+{
+  MARE_API_ASSERT(c_ptr(t), "null task_ptr");
+  return task_awaiter(c_ptr(t));
+}
+
+inline task_awaiter
+operator co_await(unsafe_task_ptr const& t)
+{
+  MARE_API_ASSERT(c_ptr(t), "null unsafe_task_ptr");
+  return task_awaiter(c_ptr(t));
+}
+
+inline group_awaiter
+operator co_await(group_ptr const& g)
+{
+  MARE_API_ASSERT(c_ptr(g), "null group_ptr");
+  return group_awaiter(g);
+}
+
+} //namespace internal
+
+} //namespace mare
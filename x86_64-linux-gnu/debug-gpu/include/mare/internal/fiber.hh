@@ -0,0 +1,254 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+// Bionic has no ucontext functions; there, mare::launch_fiber launches
+// ordinary tasks.
+#ifndef __ANDROID__
+#define MARE_HAVE_FIBERS 1
+#endif
+
+#ifdef MARE_HAVE_FIBERS
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <mare/exceptions.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/fibercontext.hh>
+#include <mare/internal/macros.hh>
+#include <mare/internal/taskfactory.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Bounded cache of fiber stacks.
+///
+/// Stacks are mapped with a PROT_NONE guard page below them, so that an
+/// overflow faults instead of corrupting the heap. At most MAX_CACHED
+/// released stacks are kept for reuse and the rest are unmapped, so the
+/// memory held by the pool is bounded by the peak number of suspended
+/// fibers plus MAX_CACHED stacks. Pages of a stack are only backed by
+/// memory once the fiber touches them.
+class fiber_stack_pool {
+public:
+  static const size_t STACK_SIZE = 256 * 1024;
+  static const size_t MAX_CACHED = 64;
+
+  static fiber_stack_pool& instance()
+  {
+    static fiber_stack_pool s_pool;
+    return s_pool;
+  }
+
+  /// Returns the lowest usable address of a STACK_SIZE stack.
+  void* acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_free.empty()) {
+        void* stack = _free.back();
+        _free.pop_back();
+        return stack;
+      }
+    }
+    size_t guard = page_size();
+    void* p = mmap(nullptr, STACK_SIZE + guard, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      MARE_FATAL("cannot map fiber stack: %s", strerror(errno));
+    if (mprotect(p, guard, PROT_NONE) != 0)
+      MARE_FATAL("cannot protect fiber stack: %s", strerror(errno));
+    return static_cast<char*>(p) + guard;
+  }
+
+  void release(void* stack)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_free.size() < MAX_CACHED) {
+        _free.push_back(stack);
+        return;
+      }
+    }
+    unmap(stack);
+  }
+
+  ~fiber_stack_pool()
+  {
+    for (auto stack : _free)
+      unmap(stack);
+  }
+
+private:
+  fiber_stack_pool() : _mutex(), _free() { }
+
+  static size_t page_size()
+  {
+    static size_t const s_page_size = sysconf(_SC_PAGESIZE);
+    return s_page_size;
+  }
+
+  static void unmap(void* stack)
+  {
+    size_t guard = page_size();
+    munmap(static_cast<char*>(stack) - guard, STACK_SIZE + guard);
+  }
+
+  std::mutex _mutex;
+  std::vector<void*> _free;
+
+  MARE_DELETE_METHOD(fiber_stack_pool(fiber_stack_pool const&));
+  MARE_DELETE_METHOD(fiber_stack_pool& operator=(fiber_stack_pool const&));
+};
+
+/// A task body running on its own stack.
+///
+/// A fiber is driven by a chain of stub tasks. Each stub switches to the
+/// fiber's stack and runs it until the body returns or reaches a
+/// suspension point (see fiber_context), then switches back. At that
+/// point the fiber's registers are saved, and the stub launches the next
+/// stub: a successor of the awaited task for wait_for(), or a yielding
+/// stub for yield(). The next stub may resume the fiber on any worker,
+/// and the worker that ran the previous stub moves on to other tasks.
+/// Stubs are not cancelable, so that a canceled awaited task still
+/// resumes the fiber, like wait_for() returns for a canceled task.
+///
+/// _done is a non-cancelable task that is launched when the body
+/// returns. It joins the group of the fiber from the start, so the group
+/// is not empty while the fiber is suspended, even if it is canceled.
+class fiber final : public fiber_context {
+public:
+  fiber(std::function<void()>&& body, task_ptr const& done) :
+    _ctx(),
+    _caller(),
+    _stack(fiber_stack_pool::instance().acquire()),
+    _body(std::move(body)),
+    _done(done),
+    _wait_for(nullptr),
+    _finished(false)
+  {
+    if (getcontext(&_ctx) != 0)
+      MARE_FATAL("getcontext failed: %s", strerror(errno));
+    _ctx.uc_stack.ss_sp = _stack;
+    _ctx.uc_stack.ss_size = fiber_stack_pool::STACK_SIZE;
+    _ctx.uc_link = nullptr;
+    // makecontext only passes int arguments.
+    uintptr_t p = reinterpret_cast<uintptr_t>(this);
+    makecontext(&_ctx, reinterpret_cast<void (*)()>(&fiber::entry), 2,
+                static_cast<unsigned>(p),
+                static_cast<unsigned>(static_cast<uint64_t>(p) >> 32));
+  }
+
+  ~fiber()
+  {
+    fiber_stack_pool::instance().release(_stack);
+  }
+
+  /// Starts the fiber on a new stub task.
+  void start()
+  {
+    schedule(nullptr);
+  }
+
+  virtual void wait_for(task* t)
+  {
+    _wait_for = t;
+    suspend();
+  }
+
+  virtual void yield()
+  {
+    _wait_for = nullptr;
+    suspend();
+  }
+
+private:
+  static void entry(unsigned lo, unsigned hi)
+  {
+    uintptr_t p = static_cast<uintptr_t>((static_cast<uint64_t>(hi) << 32) |
+                                         lo);
+    fiber* f = reinterpret_cast<fiber*>(p);
+    try {
+      f->_body();
+    } catch (abort_task_exception const&) {
+      // Same as aborting a task: the fiber ends.
+    } catch (...) {
+      MARE_FATAL("uncaught exception in fiber %p", f);
+    }
+    f->_body = nullptr;
+    f->_finished = true;
+    setcontext(&f->_caller);
+  }
+
+  void suspend()
+  {
+    swapcontext(&_ctx, &_caller);
+  }
+
+  /// Body of the stubs.
+  void resume()
+  {
+    auto& slot = current_fiber_slot();
+    fiber_context* outer = slot.get();
+    slot = this;
+    swapcontext(&_caller, &_ctx);
+    slot = outer;
+
+    if (_finished) {
+      task_ptr done = std::move(_done);
+      delete this;
+      if (done != nullptr)
+        launch(done);
+      return;
+    }
+    task* t = _wait_for;
+    _wait_for = nullptr;
+    // Last access to *this: the next stub may already be running.
+    schedule(t);
+  }
+
+  void schedule(task* pred)
+  {
+    fiber* f = this;
+    launch_stub_task([f] { f->resume(); }, pred);
+  }
+
+  ucontext_t _ctx;
+  ucontext_t _caller;
+  void* _stack;
+  std::function<void()> _body;
+  task_ptr _done;
+  task* _wait_for;
+  bool _finished;
+
+  MARE_DELETE_METHOD(fiber(fiber const&));
+  MARE_DELETE_METHOD(fiber& operator=(fiber const&));
+};
+
+} //namespace internal
+
+} //namespace mare
+
+#endif // MARE_HAVE_FIBERS
@@ -0,0 +1,252 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <mare/internal/debug.hh>
+
+namespace mare {
+
+/** @addtogroup AlignedAllocator
+@{ */
+/**
+    Page size used for memory allocated by mare::page_allocator.
+*/
+enum class huge_pages {
+  /** Base pages only. */
+  none,
+  /** Transparent huge pages: the memory is aligned to the huge page size
+      and the kernel is asked with madvise to back it with huge pages. */
+  transparent,
+  /** Explicit huge pages from the hugetlbfs pool (MAP_HUGETLB). If the
+      pool has too few free pages, falls back to transparent. */
+  hugetlb
+};
+
+/**
+    NUMA node on which mare::page_allocator places memory.
+*/
+enum class numa_placement {
+  /** Every page is placed on the node of the thread that first touches
+      it, which is the default policy of the kernel. See
+      mare::parallel_first_touch. */
+  first_touch,
+  /** Pages are preferably placed on the node of the allocating thread.
+      If that node runs out of memory, the kernel falls back to other
+      nodes rather than failing the allocation. */
+  local,
+  /** Pages are interleaved round-robin across all online nodes. */
+  interleave
+};
+/** @} */ /* end_addtogroup AlignedAllocator */
+
+namespace internal {
+
+/// Page-granular memory for mare::page_allocator.
+///
+/// Memory is mapped with mmap, so that it starts on a page boundary and
+/// its NUMA policy can be set with mbind before any page is touched.
+/// The mapped length only depends on the size and on the huge_pages
+/// option, so that page_free can recompute it instead of storing it in
+/// a header that would break the alignment. Huge page and NUMA requests
+/// are best effort: when the kernel rejects them, e.g., on a single-node
+/// machine or inside a container, the memory is still returned.
+namespace pagealloc {
+
+inline std::size_t page_size()
+{
+  static const std::size_t s_size =
+    static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return s_size;
+}
+
+inline std::size_t read_huge_page_size()
+{
+  std::size_t size = 2 * 1024 * 1024;
+  if (FILE* f = fopen("/proc/meminfo", "r")) {
+    char line[128];
+    unsigned long kb;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+      if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+        size = static_cast<std::size_t>(kb) * 1024;
+        break;
+      }
+    }
+    fclose(f);
+  }
+  return size;
+}
+
+inline std::size_t huge_page_size()
+{
+  static const std::size_t s_size = read_huge_page_size();
+  return s_size;
+}
+
+inline std::size_t round_up(std::size_t n, std::size_t multiple)
+{
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+inline std::size_t mapped_length(std::size_t size, huge_pages pages)
+{
+  return round_up(size == 0 ? 1 : size, pages == huge_pages::none ?
+                  page_size() : huge_page_size());
+}
+
+// Bitmask of the online NUMA nodes, in the format that mbind expects.
+// Empty if it cannot be determined.
+inline std::vector<unsigned long> read_online_nodes()
+{
+  std::vector<unsigned long> mask;
+  FILE* f = fopen("/sys/devices/system/node/online", "r");
+  if (f == nullptr)
+    return mask;
+  const std::size_t bits = 8 * sizeof(unsigned long);
+  unsigned long first, last;
+  while (fscanf(f, "%lu", &first) == 1) {
+    last = first;
+    int c = fgetc(f);
+    if (c == '-') {
+      if (fscanf(f, "%lu", &last) != 1)
+        break;
+      c = fgetc(f);
+    }
+    for (unsigned long n = first; n <= last; ++n) {
+      if (mask.size() <= n / bits)
+        mask.resize(n / bits + 1, 0);
+      mask[n / bits] |= 1UL << (n % bits);
+    }
+    if (c != ',')
+      break;
+  }
+  fclose(f);
+  return mask;
+}
+
+inline std::vector<unsigned long> const& online_nodes()
+{
+  static const std::vector<unsigned long> s_nodes = read_online_nodes();
+  return s_nodes;
+}
+
+inline void place(void* p, std::size_t length, numa_placement placement)
+{
+#if defined(__NR_mbind) && defined(__NR_getcpu)
+  // Values of MPOL_* in <linux/mempolicy.h>
+  const int mpol_preferred = 1;
+  const int mpol_interleave = 3;
+  const std::size_t bits = 8 * sizeof(unsigned long);
+
+  std::vector<unsigned long> mask;
+  int mode;
+  switch (placement) {
+  case numa_placement::local: {
+    unsigned cpu, node;
+    if (syscall(__NR_getcpu, &cpu, &node, nullptr) != 0)
+      return;
+    mask.resize(node / bits + 1, 0);
+    mask[node / bits] |= 1UL << (node % bits);
+    mode = mpol_preferred;
+    break;
+  }
+  case numa_placement::interleave:
+    mask = online_nodes();
+    mode = mpol_interleave;
+    break;
+  case numa_placement::first_touch:
+    return;
+  }
+  if (mask.empty())
+    return;
+  // maxnode counts one past the last bit, as in the kernel's get_nodes
+  syscall(__NR_mbind, p, length, mode, mask.data(),
+          mask.size() * bits + 1, 0);
+#else
+  MARE_UNUSED(p);
+  MARE_UNUSED(length);
+  MARE_UNUSED(placement);
+#endif
+}
+
+// Maps length bytes aligned to alignment, by mapping more and unmapping
+// the excess on both sides
+inline void* map_aligned(std::size_t length, std::size_t alignment)
+{
+  std::size_t extra = alignment > page_size() ? alignment - page_size() : 0;
+  void* m = mmap(nullptr, length + extra, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (m == MAP_FAILED)
+    return nullptr;
+  std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(m);
+  std::uintptr_t aligned = (begin + alignment - 1) &
+    ~static_cast<std::uintptr_t>(alignment - 1);
+  if (aligned > begin)
+    munmap(m, aligned - begin);
+  std::size_t tail = begin + length + extra - (aligned + length);
+  if (tail > 0)
+    munmap(reinterpret_cast<void*>(aligned + length), tail);
+  return reinterpret_cast<void*>(aligned);
+}
+
+/// Returns nullptr if no memory is available.
+inline void* allocate(std::size_t size, std::size_t alignment,
+                      huge_pages pages, numa_placement placement)
+{
+  std::size_t length = mapped_length(size, pages);
+  void* p = nullptr;
+#ifdef MAP_HUGETLB
+  if (pages == huge_pages::hugetlb && alignment <= huge_page_size()) {
+    p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED)
+      p = nullptr;
+  }
+#endif
+  if (p == nullptr) {
+    if (pages != huge_pages::none && alignment < huge_page_size())
+      alignment = huge_page_size();
+    p = map_aligned(length, alignment);
+    if (p == nullptr)
+      return nullptr;
+#ifdef MADV_HUGEPAGE
+    if (pages != huge_pages::none)
+      madvise(p, length, MADV_HUGEPAGE);
+#endif
+  }
+  place(p, length, placement);
+  return p;
+}
+
+inline void deallocate(void* p, std::size_t size, huge_pages pages)
+{
+  if (p != nullptr)
+    munmap(p, mapped_length(size, pages));
+}
+
+} //namespace pagealloc
+
+} //namespace internal
+
+} //namespace mare
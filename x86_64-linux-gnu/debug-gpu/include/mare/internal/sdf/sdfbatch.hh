@@ -0,0 +1,84 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file sdfbatch.hh */
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+
+#include <mare/internal/sdf/sdffusion.hh>
+
+namespace mare {
+namespace internal {
+
+  /// Batched Node Bodies
+  ///
+  /// Each graph iteration of a node costs a pop and push per channel plus
+  /// the bookkeeping of its partition to resume interrupted nodes. When
+  /// the node bodies only take a few nanoseconds, this overhead dominates.
+  ///
+  /// A batched body
+  ///      f_B(std::array<T1, B>& t1s, ..., std::array<Tn, B>& tns)
+  /// invokes the user body f(T1& t1, ..., Tn& tn) on elements 0, ..., B-1
+  /// of its parameters, in order. A graph whose nodes all have batched
+  /// bodies therefore performs B graph iterations of the original graph
+  /// per graph iteration, and pays the per-iteration overhead once every
+  /// B elements.
+  ///
+  /// Since the elements are processed in order by the same body object,
+  /// bodies carrying state across graph iterations retain their semantics.
+
+template<std::size_t B, typename F, typename Params>
+class batched_sdf_body;
+
+template<std::size_t B, typename F, typename ...Ts>
+class batched_sdf_body<B, F, std::tuple<Ts...> > {
+  F _f;
+
+public:
+  explicit batched_sdf_body(F const& f) :
+    _f(f) { }
+
+  void operator()(std::array<Ts, B>&... ts)
+  {
+    for(std::size_t i=0; i<B; i++)
+      _f(ts[i]...);
+  }
+};
+
+template<std::size_t B, typename F>
+struct batched_sdf_body_type {
+  static_assert(B > 0, "batch size must be > 0");
+
+  typedef typename std::decay<F>::type body_type;
+  typedef batched_sdf_body<B,
+                           body_type,
+                           typename sdf_body_traits<body_type>::param_types>
+          type;
+};
+
+} //namespace internal
+
+
+  /// See documentation in sdf.hh
+template<std::size_t B, typename F>
+typename internal::batched_sdf_body_type<B, F>::type
+batch_sdf_body(F&& f)
+{
+  return typename internal::batched_sdf_body_type<B, F>::type(f);
+}
+
+} //namespace mare
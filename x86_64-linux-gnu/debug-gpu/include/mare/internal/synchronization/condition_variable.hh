@@ -82,7 +82,7 @@ public:
   mare::cv_status
   wait_for( std::unique_lock<mare::mutex>& lock,
             const std::chrono::duration<Rep,Period>& rel_time) {
-    auto end_time = std::chrono::high_resolution_clock::now() + rel_time;
+    auto end_time = std::chrono::steady_clock::now() + rel_time;
     return wait_until(lock,end_time);
   }
 
@@ -90,12 +90,9 @@ public:
   bool wait_for( std::unique_lock<mare::mutex>& lock,
                  const std::chrono::duration<Rep, Period>& rel_time,
                  Predicate pred) {
-    while(!pred()){
-      if(wait_for(lock, rel_time) == std::cv_status::timeout){
-        return pred();
-      }
-    }
-    return true;
+    // rel_time bounds the whole wait, not each wakeup
+    auto end_time = std::chrono::steady_clock::now() + rel_time;
+    return wait_until(lock, end_time, pred);
   }
 
   template<class Clock, class Duration>
@@ -106,12 +103,7 @@ public:
 
     std::atomic<int>* state = _futex.timed_wait();
 
-    while(std::chrono::high_resolution_clock::now() < timeout_time){
-      if(*state == 1){
-        break;
-      }
-      yield();
-    }
+    internal::poll_until([state] { return *state == 1; }, timeout_time);
 
     lock.lock();
 
@@ -194,7 +186,7 @@ public:
   mare::cv_status
   wait_for( Lock& lock,
             const std::chrono::duration<Rep,Period>& rel_time) {
-    auto end_time = std::chrono::high_resolution_clock::now() + rel_time;
+    auto end_time = std::chrono::steady_clock::now() + rel_time;
     return wait_until(lock,end_time);
   }
 
@@ -202,12 +194,9 @@ public:
   bool wait_for( Lock& lock,
                  const std::chrono::duration<Rep, Period>& rel_time,
                  Predicate pred) {
-    while(!pred()){
-      if(wait_for(lock, rel_time) == std::cv_status::timeout){
-        return pred();
-      }
-    }
-    return true;
+    // rel_time bounds the whole wait, not each wakeup
+    auto end_time = std::chrono::steady_clock::now() + rel_time;
+    return wait_until(lock, end_time, pred);
   }
 
   template<class Clock, class Duration>
@@ -218,12 +207,7 @@ public:
 
     std::atomic<int>* state = _futex.timed_wait();
 
-    while(std::chrono::high_resolution_clock::now() < timeout_time){
-      if(*state == 1){
-        break;
-      }
-      yield();
-    }
+    internal::poll_until([state] { return *state == 1; }, timeout_time);
 
     lock.lock();
 
@@ -0,0 +1,196 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file pageallocator.hh */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+
+#include <mare/patterns.hh>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/pagealloc.hh>
+
+namespace mare {
+
+/**
+   STL-compliant allocator for large arrays that allocates whole pages,
+   optionally huge pages placed on chosen NUMA nodes.
+
+   Like mare::aligned_allocator, but the memory is mapped directly from
+   the kernel, starts on a page boundary (a huge page boundary unless
+   Pages is huge_pages::none), and its NUMA policy is set before any
+   page is touched. Every allocation takes at least one page, so this
+   allocator is meant for a few large arrays, not for node-based
+   containers.
+
+   Huge pages reduce TLB misses on large working sets. With
+   numa_placement::first_touch, which is the default, initialize the
+   memory with mare::parallel_first_touch so that its pages are spread
+   over the nodes of the workers instead of all landing on the node of
+   the allocating thread.
+
+   @tparam T Type of the element to allocate.
+   @tparam Pages Page size of the memory.
+   @tparam Placement NUMA placement of the memory.
+   @ingroup AlignedAllocator
+*/
+
+// squelch GCC complaints about non-virtual destructor
+MARE_GCC_IGNORE_BEGIN("-Weffc++");
+
+template <class T, huge_pages Pages = huge_pages::transparent,
+          numa_placement Placement = numa_placement::first_touch>
+// Inherit construct(), destruct() etc.
+struct page_allocator : public std::allocator<T>
+{
+
+MARE_GCC_IGNORE_END("-Weffc++");
+
+  typedef std::size_t size_type;
+  typedef T* pointer;
+  typedef T const* const_pointer;
+
+  //Defines a page allocator suitable for allocating elements of type U.
+  template <class U>
+  struct rebind {
+    typedef page_allocator<U,Pages,Placement> other;
+  };
+
+
+  //Default-constructs an allocator.
+  page_allocator() throw() {}
+
+
+  //Copy-constructs an allocator.
+  page_allocator(const page_allocator& other) throw() :
+    std::allocator<T>(other) {}
+
+
+  //Convert-constructs an allocator.
+  template <class U>
+  page_allocator(const page_allocator<U,Pages,Placement>&) throw() {}
+
+
+  //Destroys an allocator.
+  ~page_allocator() throw() {}
+
+
+  //Allocates n elements of type T on whole pages.
+  pointer allocate(size_type n) {
+    return allocate(n, const_pointer(0));
+  }
+
+
+  //Allocates n elements of type T on whole pages.
+  pointer allocate(size_type n, const_pointer) {
+    if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+      throw std::bad_alloc();
+    void* p = internal::pagealloc::allocate(n * sizeof(T), alignof(T),
+                                            Pages, Placement);
+    if (!p)
+      throw std::bad_alloc();
+
+    return static_cast<pointer>(p);
+  }
+
+
+  //Unmaps the memory previously allocated by a page allocator.
+  void deallocate(pointer p, size_type n) {
+    internal::pagealloc::deallocate(p, n * sizeof(T), Pages);
+  }
+
+};
+
+
+/**
+   Checks whether two page allocators are equal. Two allocators are equal
+   if the memory allocated using one allocator can be deallocated by the
+   other.
+   @returns True if both allocators use the same page size.
+   @ingroup AlignedAllocator
+*/
+template <class T1, huge_pages P1, numa_placement N1,
+          class T2, huge_pages P2, numa_placement N2>
+bool operator == (const page_allocator<T1,P1,N1> &,
+                  const page_allocator<T2,P2,N2> &)
+{
+  return P1 == P2;
+}
+
+
+/**
+   Checks whether two page allocators are not equal.
+   @returns True if the allocators use different page sizes.
+   @ingroup AlignedAllocator
+*/
+template <class T1, huge_pages P1, numa_placement N1,
+          class T2, huge_pages P2, numa_placement N2>
+bool operator != (const page_allocator<T1,P1,N1> &,
+                  const page_allocator<T2,P2,N2> &)
+{
+  return P1 != P2;
+}
+
+
+/**
+   Constructs the elements of [first, last) in parallel, page by page.
+
+   Under the first-touch policy of the kernel, a page is placed on the
+   NUMA node of the thread that writes it first. Constructing an array
+   from a single thread therefore puts all of it on one node, and every
+   other node reads it remotely later on. This function constructs each
+   page, or huge page if <tt>pages</tt> says so, from one MARE task
+   using mare::pfor_each, so that the pages are spread over the nodes of
+   the workers. Later parallel loops over the same range see mostly
+   local pages, although work stealing does not guarantee that a page
+   is processed by the worker that placed it.
+
+   @param first First element; usually from mare::page_allocator.
+   @param last  One past the last element.
+   @param value Value to which every element is initialized.
+   @param pages Page size of the memory.
+
+   @ingroup AlignedAllocator
+*/
+template<typename T>
+void parallel_first_touch(T* first, T* last, T const& value = T(),
+                          huge_pages pages = huge_pages::none)
+{
+  if (first >= last)
+    return;
+  const std::size_t block = pages == huge_pages::none ?
+    internal::pagealloc::page_size() : internal::pagealloc::huge_page_size();
+  const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(first);
+  const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(last);
+  const std::uintptr_t base = begin & ~static_cast<std::uintptr_t>(block - 1);
+  const std::size_t num_blocks = (end - base + block - 1) / block;
+
+  // Every element is constructed by the block its first byte falls into
+  pfor_each(std::size_t(0), num_blocks, [=, &value] (std::size_t b) {
+      std::uintptr_t lo = std::max(begin, base + b * block);
+      std::uintptr_t hi = std::min(end, base + (b + 1) * block);
+      T* p = first + (lo - begin + sizeof(T) - 1) / sizeof(T);
+      T* q = std::min(last, first + (hi - begin + sizeof(T) - 1) / sizeof(T));
+      for (; p < q; ++p)
+        new (p) T(value);
+    });
+}
+
+}; // namespace mare
@@ -17,6 +17,9 @@
 
 #include <mare/channel.hh>
 #include <mare/internal/sdf/sdfapiimplementation.hh>
+#include <mare/internal/sdf/sdfbatch.hh>
+#include <mare/internal/sdf/sdffusion.hh>
+#include <mare/internal/sdf/sdfreplicate.hh>
 #include <mare/sdfpr.hh>
 
 namespace mare {
@@ -165,6 +168,249 @@ create_sdf_node(
 */
 void assign_cost(sdf_node_ptr n, double execution_cost);
 
+/**
+  Measures the execution cost of the node over its next graph iterations.
+
+  The execution time of the node body is measured on each of the next
+  <tt>num_iterations</tt> graph iterations executed by the node. Only the
+  node body is timed, not the popping and pushing of channel values. Any
+  previous measurement of the node is discarded.
+
+  Must only be called when the graph of the node is not executing, e.g.,
+  before the graph is launched, after wait_for() or while the graph is
+  paused, since the measurement is updated by the executing node without
+  synchronization.
+
+  A graph is partitioned once, when it is launched, so measured costs
+  cannot rebalance the graph they were measured on. Instead, a graph can be
+  launched for a few iterations to profile its nodes, and the measured costs
+  passed to assign_cost() on the corresponding nodes of the graph used for
+  the actual computation.
+
+  @param n Handle to an SDF node.
+
+  @param num_iterations Number of graph iterations to measure.
+
+  @sa get_measured_cost()
+*/
+void profile_cost(sdf_node_ptr n, std::size_t num_iterations);
+
+/**
+  Returns the execution cost measured for the node.
+
+  Must only be called when the graph of the node is not executing, e.g.,
+  after wait_for() or while the graph is paused.
+
+  @param n Handle to an SDF node.
+
+  @return
+  The mean execution time of the node body in microseconds, over the graph
+  iterations measured since the last call to profile_cost(), or 0.0 if no
+  graph iteration has been measured. Suitable for use as the
+  <tt>execution_cost</tt> argument of assign_cost().
+
+  @sa profile_cost()
+*/
+double get_measured_cost(sdf_node_ptr n);
+
+
+//////////////
+// Node fusion
+
+/**
+  Fuses the bodies of a linear chain of nodes into the body of a single node.
+
+  Consider a chain of nodes
+  @par
+  <tt>f1 -> (dc1) -> f2 -> (dc2) -> ... -> fn</tt>
+
+  where each <tt>dc</tt> is connected only between two consecutive nodes of the
+  chain and carries no preloaded values. Executed as separate nodes, every
+  element passed along the chain is pushed into and popped from a channel,
+  even when the nodes are placed in the same partition. Passing the returned
+  body to create_sdf_node() instead creates a single node that invokes
+  <tt>f1</tt> to <tt>fn</tt> in sequence within one firing. The elements of the
+  intermediate channels are held in local variables of the fused body and the
+  intermediate channels are not created at all.
+
+  The last parameter of each body is taken as the element passed to the next
+  body in the chain, which accepts it as its first parameter. Both parameters
+  must have the same user-data-type, which must be default-constructible:
+  the fused body default-constructs each intermediate element before the
+  body that produces it is invoked. The fused body accepts the parameters
+  of <tt>f1</tt> except its last, followed by the parameters of <tt>f2</tt> to
+  <tt>fn</tt> except their first, and must be connected to the corresponding
+  channels in that order.
+
+  The fused node fires once per graph iteration, as each of the original nodes
+  would, so pause(), resume() and cancel() behave as for the unfused chain.
+  Since the chain now executes as one node, it can no longer be spread across
+  partitions: fuse only nodes whose combined cost is small compared to the
+  rest of the graph, and assign the sum of their costs to the fused node.
+
+  Fusion pays off for chains of small bodies placed in the same partition as
+  their neighbors. There, the nodes fire back to back, and pushing and popping
+  the intermediate channels is a large part of the cost of an iteration. Next
+  to the hand-over of elements between partitions, the saved channel
+  operations matter little.
+
+  @param f1 Body of the first node of the chain.
+  @param f2 Body of the second node of the chain.
+  @param fs Bodies of the remaining nodes of the chain, if any.
+
+  @return
+  A callable object suitable as the <tt>body</tt> of create_sdf_node().
+
+  @sa create_sdf_node()
+  @sa assign_cost()
+*/
+template<typename F1, typename F2, typename ...Fs>
+typename internal::fused_sdf_chain_type<F1, F2, Fs...>::type
+fuse_sdf_bodies(F1&& f1, F2&& f2, Fs&&... fs);
+
+
+//////////////
+// Node batching
+
+/**
+  Batches <tt>B</tt> graph iterations of a node body into a single firing.
+
+  Every graph iteration of a node pops and pushes each of its channels, and
+  the partition executing the node keeps track of where to resume it if a
+  channel blocks. For node bodies that only take a few nanoseconds, this
+  per-iteration overhead far exceeds the work done by the bodies.
+
+  The returned body accepts a <tt>std::array<T, B></tt> for each parameter
+  <tt>T&</tt> of <tt>f</tt>, and invokes <tt>f</tt> on elements
+  <tt>0</tt> to <tt>B-1</tt> of the arrays, in order. A graph built from
+  batched bodies, with channels carrying <tt>std::array<T, B></tt>, performs
+  <tt>B</tt> graph iterations of the unbatched graph per graph iteration,
+  and pays the per-iteration overhead once per <tt>B</tt> elements.
+
+  <tt>B</tt> trades latency for throughput: the first element of a batch
+  only reaches the next node once all <tt>B</tt> elements of the batch are
+  processed, and each channel buffers <tt>B</tt> times as many elements.
+  Use <tt>B = 1</tt> for latency-sensitive pipelines, and larger
+  <tt>B</tt> for tiny bodies where throughput matters. All nodes connected by
+  batched channels must use the same <tt>B</tt>, and preloaded channels
+  must be preloaded with whole batches.
+
+  Since <tt>f</tt> processes the elements in order, bodies carrying state
+  across graph iterations retain their semantics.
+
+  @tparam B Number of graph iterations batched per firing. Must be > 0.
+
+  @param f Body of the node, as accepted by create_sdf_node().
+
+  @return
+  A callable object suitable as the <tt>body</tt> of create_sdf_node().
+
+  @sa create_sdf_node()
+*/
+template<std::size_t B, typename F>
+typename internal::batched_sdf_body_type<B, F>::type
+batch_sdf_body(F&& f);
+
+
+//////////////
+// Node replication
+
+/**
+  Creates a node whose graph iterations execute concurrently across
+  multiple replicas of its body.
+
+  A node executes its graph iterations one after the other, so a node that
+  is much heavier than the rest of the graph limits the throughput of the
+  whole graph to what a single core can sustain. If <tt>body</tt> is
+  stateless, i.e., the values it writes to its outputs on a graph iteration
+  depend only on the values it reads from its inputs on that iteration,
+  the node can instead be replicated.
+
+  Graph iteration <tt>i</tt> of the replicated node is executed by replica
+  <tt>i % num_replicas</tt>. Once the replicas are placed in different
+  partitions, consecutive graph iterations of the node execute concurrently.
+  The outputs are pushed in graph iteration order regardless of the order in
+  which the replicas complete, so the rest of the graph observes the same
+  values as for a node created by create_sdf_node().
+
+  Internally, the replicated node is built from ordinary SDF nodes and
+  channels: a node counting graph iterations, a node distributing the
+  inputs to the replicas, the replicas, and a node collecting the outputs of
+  the replicas. pause(), resume() and cancel() behave as they do for the
+  equivalent unreplicated node.
+
+  Undefined behavior if <tt>body</tt> carries state across graph iterations,
+  since each replica holds its own copy of <tt>body</tt> and observes only
+  every <tt>num_replicas</tt>-th graph iteration.
+
+  @param g Handle to the graph in which this node is to be created.
+
+  @param num_replicas Number of replicas of <tt>body</tt>. Must be > 0.
+  Typically no more than the number of cores available to the graph.
+
+  @param body A stateless function or callable object accepting references
+  to the user-data-types of the input channels, followed by the
+  user-data-types of the output channels, as with create_sdf_node().
+
+  @param inputs The input channels, created with with_inputs().
+
+  @param outputs The output channels, created with with_outputs().
+
+  @return
+  A handle to the replicated node. The handle owns the channels internal to
+  the replicated node, and must be destroyed with
+  destroy_replicated_sdf_node() after the graph has been destroyed.
+
+  @sa assign_cost(sdf_replicated_node_ptr, double) to indicate the cost of
+  <tt>body</tt>, which guides the placement of the replicas in partitions.
+*/
+template<typename Body, typename ...Ins, typename ...Outs>
+sdf_replicated_node_ptr create_replicated_sdf_node(
+  sdf_graph_ptr                 g,
+  std::size_t                   num_replicas,
+  Body&&                        body,
+  io_channels<Ins...> const&    inputs,
+  io_channels<Outs...> const&   outputs);
+
+/**
+  Assigns an execution cost to the body of a replicated node.
+
+  Each replica is assigned an equal share of <tt>execution_cost</tt>, since
+  each replica executes <tt>body</tt> on only a fraction of the graph
+  iterations.
+
+  @param rn Handle to a replicated SDF node.
+
+  @param execution_cost The execution cost of a single invocation of the
+  body of the replicated node.
+
+  @sa assign_cost(sdf_node_ptr, double)
+*/
+void assign_cost(sdf_replicated_node_ptr rn, double execution_cost);
+
+/**
+  Retrieves the handles to the replicas of a replicated node.
+
+  @param rn Handle to a replicated SDF node.
+
+  @return
+  Handles to the nodes executing the replicas of the body, with the
+  replica executing graph iteration <tt>i</tt> at index
+  <tt>i % num_replicas</tt>.
+*/
+std::vector<sdf_node_ptr> const&
+get_replicas(sdf_replicated_node_ptr rn);
+
+/**
+  Destroys a replicated node, releasing the channels internal to it.
+
+  Invoke after the graph containing the replicated node has been
+  destroyed via destroy_sdf_graph().
+
+  @param rn Handle to the replicated node to be destroyed.
+*/
+void destroy_replicated_sdf_node(sdf_replicated_node_ptr& rn);
+
 
 
 //////////////
@@ -491,6 +737,37 @@ bool pause(
 */
 void resume(sdf_graph_ptr g);
 
+/**
+  Replaces the body of a node, without tearing down its graph.
+
+  Nodes and channels cannot be added to or removed from a graph once it is
+  launched. The body of a node, however, can be replaced at any time, for
+  example to swap a filter of a running pipeline. The graph keeps running,
+  its partitioning is unchanged, and the values buffered in all channels,
+  including those of node <tt>n</tt>, are preserved.
+
+  The new body is installed by the node right before it next executes its
+  body, so the body is never replaced while executing. To switch bodies at a
+  known graph iteration, pause the graph at that iteration with
+  <tt>sdf_interrupt_type::iter_synced</tt>, replace the body, then
+  resume(): the node executes all remaining graph iterations with the new
+  body. If replace_sdf_node_body() is called again before the node installs
+  the previous replacement, the previous replacement is discarded.
+
+  @param n Handle to an SDF node.
+
+  @param body The new body. Must accept the same parameters as the body the
+  node was created with. If the node was created with a plain function,
+  <tt>body</tt> must be convertible to a function pointer.
+
+  @sa pause(sdf_graph_ptr g,
+            std::size_t   desired_pause_iteration,
+            sdf_interrupt_type intr_type)
+  @sa resume()
+*/
+template<typename Body>
+void replace_sdf_node_body(sdf_node_ptr n, Body&& body);
+
 
 /**
   Query information about the state of an SDF graph.
@@ -0,0 +1,98 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file shared_mutex.hh */
+#pragma once
+
+#include <mare/internal/synchronization/shared_mutex.hh>
+
+namespace mare{
+/** @cond */
+typedef internal::shared_mutex shared_mutex;
+/** @endcond */
+}; //namespace mare
+
+#ifdef ONLY_FOR_DOXYGEN
+
+namespace mare {
+
+/** @addtogroup sync
+@{ */
+/**
+    Provides shared (reader) and exclusive (writer) access.
+
+    Any number of tasks may hold the mutex in shared mode at the same
+    time, or a single task may hold it in exclusive mode. Tasks that
+    wait for the mutex do not block the MARE scheduler.
+
+    Shared owners register in per-thread reader counts, so readers on
+    different worker threads do not contend with each other. Writers are
+    preferred: once a task calls lock(), no new task acquires the mutex
+    in shared mode until all waiting writers have released it.
+*/
+class shared_mutex{
+public:
+
+  /** Default constructor. Initializes to not locked. */
+  shared_mutex();
+
+  shared_mutex(shared_mutex&) = delete;
+  shared_mutex(shared_mutex&&) = delete;
+  shared_mutex& operator=(shared_mutex const&) = delete;
+
+  /**
+      Acquires the mutex in exclusive mode, waits if the mutex is
+      not available.
+
+      May yield to the MARE scheduler.
+  */
+  void lock();
+
+  /**
+      Attempts to acquire the mutex in exclusive mode.
+
+      @return
+      TRUE -- Successfully acquired the mutex.\n
+      FALSE -- Did not acquire the mutex.
+  */
+  bool try_lock();
+
+  /** Releases the mutex from exclusive mode. */
+  void unlock();
+
+  /**
+      Acquires the mutex in shared mode, waits while a writer holds or
+      waits for the mutex.
+
+      May yield to the MARE scheduler.
+  */
+  void lock_shared();
+
+  /**
+      Attempts to acquire the mutex in shared mode.
+
+      @return
+      TRUE -- Successfully acquired the mutex.\n
+      FALSE -- Did not acquire the mutex.
+  */
+  bool try_lock_shared();
+
+  /** Releases the mutex from shared mode. */
+  void unlock_shared();
+};
+/** @} */ /* end_addtogroup sync */
+};
+
+
+#endif //ONLY_FOR_DOXYGEN
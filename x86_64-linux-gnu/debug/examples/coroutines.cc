@@ -0,0 +1,92 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <mare/mare.h>
+#include <mare/coroutine.hh>
+#include <mare/mutex.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. write MARE code as C++20 coroutines with mare::coro_task, and
+//  2. co_await tasks, groups, mutexes and other coroutines without
+//     blocking a worker.
+//
+//  Build with -std=c++20 (GCC 11 or later).
+
+#ifdef MARE_HAVE_COROUTINES
+
+mare::mutex s_mutex;
+int s_total = 0;
+
+// Computes x * x in a task, and waits for it.
+mare::coro_task<int>
+square(int x)
+{
+  int result = 0;
+  auto t = mare::create_task([x, &result] { result = x * x; });
+  mare::launch(t);
+  co_await t;
+  co_return result;
+}
+
+// Sums squares, first one by one through another coroutine, then in
+// parallel in a group.
+mare::coro_task<int>
+sum_of_squares(int n)
+{
+  int sum = 0;
+  for (int i = 0; i < n; i++)
+    sum += co_await square(i);
+
+  int parallel[16] = {0};
+  auto g = mare::create_group();
+  for (int i = 0; i < n; i++)
+    mare::launch(g, [i, &parallel] { parallel[i] = i * i; });
+  co_await g;
+  for (int i = 0; i < n; i++)
+    sum += parallel[i];
+
+  auto lock = co_await mare::lock_async(s_mutex);
+  s_total += sum;
+  co_return sum;
+}
+
+int main() {
+
+  // Initialize the MARE runtime.
+  mare::runtime::init();
+
+  mare::coro_task<int> c = sum_of_squares(16);
+  auto done = c.launch();
+  mare::wait_for(done);
+  MARE_ALOG("sum of squares: %d (expected %d)", c.get(), 2 * 1240);
+
+  // Shutdown the MARE runtime.
+  mare::runtime::shutdown();
+
+  return 0;
+}
+
+#else
+
+int main() {
+  MARE_ALOG("coroutines require C++20");
+  return 0;
+}
+
+#endif // MARE_HAVE_COROUTINES
@@ -0,0 +1,121 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <array>
+#include <cassert>
+#include <chrono>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/sdf.hh>
+
+///////////////
+//
+//  Pipeline
+//     source -> (dc1) -> scale -> (dc2) -> sink
+//
+//  Goal is to
+//  1. illustrate the use of mare::batch_sdf_body() to process B graph
+//     iterations of tiny node bodies per firing of the nodes, and
+//  2. compare the throughput of the pipeline for increasing B.
+//
+//  The node bodies only take a few nanoseconds, so the unbatched pipeline
+//  spends most of its time popping and pushing channels. The same bodies
+//  are batched by wrapping them with mare::batch_sdf_body<B>(), and
+//  connecting them with channels carrying std::array<int, B>. The batched
+//  graph is launched for num_elements / B graph iterations, and processes
+//  the same elements, in the same order, as the unbatched graph.
+//
+//  Please first see examples/sdfbasicpipe.cc for the basic mechanisms
+//  to construct a graph and execute it.
+
+const std::size_t num_elements = 1 << 18;
+
+// Returns the throughput of the pipeline, in elements/s
+template<std::size_t B>
+double
+run_pipeline(long long& sum)
+{
+  static_assert(num_elements % B == 0, "B must divide num_elements");
+
+  mare::data_channel< std::array<int, B> > dc1, dc2;
+  mare::sdf_graph_ptr g = mare::create_sdf_graph();
+
+  int x = 0;
+  mare::create_sdf_node(g,
+                        mare::batch_sdf_body<B>([&x](int& out)
+                                                {
+                                                  out = x++;
+                                                }),
+                        mare::with_outputs(dc1));
+
+  mare::create_sdf_node(g,
+                        mare::batch_sdf_body<B>([](int& in, int& out)
+                                                {
+                                                  out = 3 * in;
+                                                }),
+                        mare::with_inputs(dc1),
+                        mare::with_outputs(dc2));
+
+  sum = 0;
+  mare::create_sdf_node(g,
+                        mare::batch_sdf_body<B>([&sum](int& in)
+                                                {
+                                                  sum += in;
+                                                }),
+                        mare::with_inputs(dc2));
+
+  auto start = std::chrono::system_clock::now();
+  mare::launch_and_wait(g, num_elements / B);
+  auto end = std::chrono::system_clock::now();
+
+  mare::destroy_sdf_graph(g);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_elements) / seconds;
+}
+
+template<std::size_t B>
+void
+report(double baseline)
+{
+  long long sum;
+  double throughput = run_pipeline<B>(sum);
+  MARE_LLOG("B = %4zu: %12.1f elements/s (%.2fx)",
+            B, throughput, throughput / baseline);
+
+  long long n = num_elements;
+  assert(sum == 3 * n * (n - 1) / 2);
+  MARE_UNUSED(n);
+  MARE_UNUSED(sum);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  long long sum;
+  double baseline = run_pipeline<1>(sum);
+  MARE_LLOG("B = %4d: %12.1f elements/s", 1, baseline);
+
+  report<16>(baseline);
+  report<256>(baseline);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <chrono>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/sdf/sdfdebug.hh>
+#include <mare/mare.h>
+#include <mare/sdf.hh>
+
+///////////////
+//
+//  Pipeline
+//     source -> (dc1) -> scale -> (dc2) -> offset -> (dc3) -> clamp
+//                                                      -> (dc4) -> sink
+//
+//  Goal is to
+//  1. illustrate the use of mare::fuse_sdf_bodies() to fuse the bodies of
+//     a linear chain of nodes (scale -> offset -> clamp) into the body of a
+//     single node, and
+//  2. compare the execution time of the fused and unfused chain when the
+//     whole graph is placed in a single partition.
+//
+//  The node bodies are deliberately tiny. Within a single partition, the
+//  nodes fire one after the other without any hand-over between
+//  partitions, so pushing and popping the channels dominates the cost of
+//  an iteration. The fused node passes the values of dc2 and dc3 in local
+//  variables instead, which saves two of the four channels of the graph.
+//
+//  Please first see examples/sdfbasicpipe.cc for the basic mechanisms
+//  to construct a graph and execute it, and examples/sdfadvanceddebug.cc
+//  for the manual partitioning used here.
+
+const std::size_t num_iterations = 200000;
+
+void scale(int& in, int& out)
+{
+  out = in * 3;
+}
+
+void offset(int& in, int& out)
+{
+  out = in + 7;
+}
+
+void clamp(int& in, int& out)
+{
+  out = (in > 1000 ? 1000 : in);
+}
+
+long long int
+run_pipeline(bool fuse_chain, long long int& checksum)
+{
+  mare::data_channel<int> dc1, dc2, dc3, dc4;
+
+  mare::sdf_graph_ptr g = mare::create_sdf_graph();
+
+  int x = 0;
+  auto source = mare::create_sdf_node(g,
+                                      [&x](int& out)
+                                      {
+                                        out = x++ % 512;
+                                      },
+                                      mare::with_outputs(dc1));
+
+  checksum = 0;
+  auto sink = mare::create_sdf_node(g,
+                                    [&checksum](int& in)
+                                    {
+                                      checksum += in;
+                                    },
+                                    mare::with_inputs(dc4));
+
+  // The whole graph executes in one partition. The nodes of a partition
+  // fire in the order in which they are assigned to it, so the nodes are
+  // assigned in pipeline order.
+  mare::internal::set_sdf_num_partitions(g, 1);
+  mare::internal::set_sdf_node_partition(source, 0);
+
+  if(fuse_chain) {
+    // dc2 and dc3 are not connected at all: their values are passed
+    // between the fused bodies within a single firing.
+    auto fused = mare::create_sdf_node(g,
+                                       mare::fuse_sdf_bodies(scale,
+                                                             offset,
+                                                             clamp),
+                                       mare::with_inputs(dc1),
+                                       mare::with_outputs(dc4));
+    mare::internal::set_sdf_node_partition(fused, 0);
+    MARE_LLOG("fused chain scale -> offset -> clamp into node %zu",
+              mare::get_debug_id(fused));
+  } else {
+    auto n_scale  = mare::create_sdf_node(g, scale,
+                                          mare::with_inputs(dc1),
+                                          mare::with_outputs(dc2));
+    auto n_offset = mare::create_sdf_node(g, offset,
+                                          mare::with_inputs(dc2),
+                                          mare::with_outputs(dc3));
+    auto n_clamp  = mare::create_sdf_node(g, clamp,
+                                          mare::with_inputs(dc3),
+                                          mare::with_outputs(dc4));
+    mare::internal::set_sdf_node_partition(n_scale,  0);
+    mare::internal::set_sdf_node_partition(n_offset, 0);
+    mare::internal::set_sdf_node_partition(n_clamp,  0);
+    MARE_LLOG("unfused chain scale -> offset -> clamp as nodes %zu, %zu, %zu",
+              mare::get_debug_id(n_scale),
+              mare::get_debug_id(n_offset),
+              mare::get_debug_id(n_clamp));
+  }
+
+  mare::internal::set_sdf_node_partition(sink, 0);
+
+  auto start = std::chrono::system_clock::now();
+  mare::launch_and_wait(g, num_iterations);
+  auto end = std::chrono::system_clock::now();
+
+  mare::destroy_sdf_graph(g);
+
+  return std::chrono::duration_cast<std::chrono::microseconds>
+                                                    (end - start).count();
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  long long int unfused_checksum, fused_checksum;
+  long long int unfused_us = run_pipeline(false, unfused_checksum);
+  long long int fused_us   = run_pipeline(true,  fused_checksum);
+
+  MARE_LLOG("unfused: %lld us for %zu iterations", unfused_us, num_iterations);
+  MARE_LLOG("fused:   %lld us for %zu iterations", fused_us,   num_iterations);
+
+  // Fusion does not change the values computed by the graph
+  if(unfused_checksum != fused_checksum)
+    MARE_FATAL("checksum mismatch: unfused %lld, fused %lld",
+               unfused_checksum, fused_checksum);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
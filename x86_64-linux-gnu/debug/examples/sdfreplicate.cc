@@ -0,0 +1,142 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/sdf.hh>
+
+///////////////
+//
+//  Pipeline
+//     source -> (dc1) -> heavy -> (dc2) -> sink
+//
+//  Goal is to
+//  1. illustrate the use of mare::create_replicated_sdf_node() to execute
+//     the graph iterations of a heavy, stateless node concurrently across
+//     multiple replicas of its body, and
+//  2. measure the throughput of the pipeline as the number of replicas
+//     grows.
+//
+//  heavy is far more expensive than source and sink, so with a plain node
+//  the pipeline cannot run faster than one invocation of heavy per graph
+//  iteration on a single core. The replicated node executes consecutive
+//  graph iterations of heavy on different cores, while sink still
+//  observes the results in graph iteration order.
+//
+//  Please first see examples/sdfbasicpipe.cc for the basic mechanisms
+//  to construct a graph and execute it, and examples/sdfassigncost.cc
+//  for the use of node costs in partitioning.
+
+const std::size_t num_iterations = 2000;
+
+// Stateless: the output depends only on the input of the same iteration
+void heavy(int& in, double& out)
+{
+  double x = in;
+  for(int i=0; i<20000; i++)
+    x = std::sqrt(x + i);
+  out = x;
+}
+
+double
+run_pipeline(std::size_t num_replicas, bool& in_order)
+{
+  mare::data_channel<int>    dc1;
+  mare::data_channel<double> dc2;
+
+  mare::sdf_graph_ptr g = mare::create_sdf_graph();
+
+  int x = 0;
+  mare::create_sdf_node(g,
+                        [&x](int& out)
+                        {
+                          out = x++;
+                        },
+                        mare::with_outputs(dc1));
+
+  mare::sdf_replicated_node_ptr rn = nullptr;
+  if(num_replicas == 0) {
+    // baseline: plain node
+    auto n = mare::create_sdf_node(g, heavy,
+                                   mare::with_inputs(dc1),
+                                   mare::with_outputs(dc2));
+    mare::assign_cost(n, 100.0);
+  } else {
+    rn = mare::create_replicated_sdf_node(g, num_replicas, heavy,
+                                          mare::with_inputs(dc1),
+                                          mare::with_outputs(dc2));
+    mare::assign_cost(rn, 100.0);
+  }
+
+  // sink checks that results arrive in graph iteration order
+  int expected = 0;
+  in_order = true;
+  mare::create_sdf_node(g,
+                        [&expected, &in_order](double& in)
+                        {
+                          // spot-check the first few results only,
+                          // to keep sink cheap
+                          int y = expected++;
+                          if(y < 16) {
+                            double ref;
+                            heavy(y, ref);
+                            in_order = in_order && (in == ref);
+                          }
+                        },
+                        mare::with_inputs(dc2));
+
+  auto start = std::chrono::system_clock::now();
+  mare::launch_and_wait(g, num_iterations);
+  auto end = std::chrono::system_clock::now();
+
+  mare::destroy_sdf_graph(g);
+  if(rn != nullptr)
+    mare::destroy_replicated_sdf_node(rn);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(num_iterations) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  std::size_t max_replicas = std::thread::hardware_concurrency();
+  if(max_replicas < 2)
+    max_replicas = 2;
+
+  bool in_order;
+  double baseline = run_pipeline(0, in_order);
+  MARE_LLOG("plain node:  %10.1f iterations/s", baseline);
+  assert(in_order);
+
+  for(std::size_t r=1; r<=max_replicas; r*=2) {
+    double throughput = run_pipeline(r, in_order);
+    MARE_LLOG("%2zu replicas: %10.1f iterations/s (%.2fx)",
+              r, throughput, throughput / baseline);
+    assert(in_order);
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
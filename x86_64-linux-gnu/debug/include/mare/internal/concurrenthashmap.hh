@@ -0,0 +1,400 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+#include <mare/internal/reclamation.hh>
+#include <mare/internal/synchronization/mutex.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Concurrent hash map
+///
+/// Buckets are singly linked lists of immutable nodes; a value is never
+/// updated in place, but by linking a new node in place of the old one.
+///
+/// Writers (insert, assign, erase) serialize per lock stripe. There are
+/// num_stripes stripes, and bucket b of any table belongs to stripe
+/// b % num_stripes. Since table sizes are powers of two no smaller than
+/// num_stripes, a key maps to the same stripe in every table.
+///
+/// Readers take no lock. Unlinked nodes are handed to the reclamation
+/// domain chosen by Reclamation (see reclamation.hh), which deletes them
+/// once no reader can reach them anymore. With hazard pointers, readers
+/// walk a bucket with the protocol of M. Michael's lock-free lists: a
+/// node is only dereferenced after it has been published in a hazard
+/// pointer slot and found still linked. To make "still linked" checkable,
+/// a writer first marks the next pointer of a node it unlinks (sets its
+/// lowest bit); a reader that finds a marked next pointer starts over at
+/// the head of the bucket. With epochs, a reader walks the bucket inside
+/// a critical section and needs no re-checks.
+///
+/// Resize is incremental. When a stripe grows beyond the load factor, a
+/// table of twice the size is attached to the current table as _next.
+/// Afterwards every write migrates a few buckets: the nodes of the bucket
+/// are copied to the new table, the old nodes are marked and retired, and
+/// the old bucket is set to moved(). Readers and writers that find moved()
+/// in a bucket continue in the next table. Once all buckets have been
+/// migrated, the new table becomes the current table. Tables are only
+/// freed with the map; since each table is twice the size of its
+/// predecessor, they take at most as much memory as the current table.
+template<typename Key, typename T, typename Hash, typename KeyEqual,
+         typename Reclamation>
+class concurrent_hash_map {
+private:
+  struct node {
+    node(Key const& key, T const& value, size_t hash, node* next) :
+      _key(key),
+      _value(value),
+      _hash(hash),
+      _next(next) {}
+
+    MARE_DELETE_METHOD(node(node const&));
+    MARE_DELETE_METHOD(node& operator=(node const&));
+
+    Key const _key;
+    T const _value;
+    size_t const _hash;
+    std::atomic<node*> _next;
+  };
+
+  struct table {
+    explicit table(size_t size) :
+      _mask(size - 1),
+      _buckets(new std::atomic<node*>[size]),
+      _next(nullptr),
+      _cursor(0),
+      _migrated(0) {
+      for (size_t i = 0; i < size; ++i)
+        _buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~table() { delete[] _buckets; }
+
+    MARE_DELETE_METHOD(table(table const&));
+    MARE_DELETE_METHOD(table& operator=(table const&));
+
+    size_t size() const { return _mask + 1; }
+    std::atomic<node*>& bucket(size_t hash) { return _buckets[hash & _mask]; }
+
+    size_t const _mask;
+    std::atomic<node*>* const _buckets;
+
+    // Table being migrated to, if any
+    std::atomic<table*> _next;
+    // Next bucket to be claimed for migration
+    std::atomic<size_t> _cursor;
+    // Number of buckets migrated so far
+    std::atomic<size_t> _migrated;
+  };
+
+  struct stripe {
+    stripe() : _lock(), _count(0) {}
+
+    mare::internal::mutex _lock;
+    std::atomic<size_t> _count;
+  };
+
+  static const size_t num_stripes = 64;
+
+  // Number of buckets each write helps to migrate
+  static const size_t migrate_per_write = 2;
+
+  static bool is_marked(node* n) {
+    return (reinterpret_cast<uintptr_t>(n) & 1) != 0;
+  }
+  static node* marked(node* n) {
+    return reinterpret_cast<node*>(reinterpret_cast<uintptr_t>(n) | 1);
+  }
+  static node* unmarked(node* n) {
+    return reinterpret_cast<node*>(reinterpret_cast<uintptr_t>(n) & ~
+                                   static_cast<uintptr_t>(1));
+  }
+  // Bucket value of a bucket that has been migrated to the next table
+  static node* moved() { return marked(nullptr); }
+
+  Hash _hash;
+  KeyEqual _key_equal;
+
+  table* const _first;
+  std::atomic<table*> _table;
+  stripe _stripes[num_stripes];
+
+  // Slots 0 and 1 protect the current and the next node of a walk
+  typedef typename Reclamation::template domain<node, 2>::type
+          reclamation_domain;
+  reclamation_domain& _rec;
+
+  stripe& stripe_of(size_t hash) { return _stripes[hash % num_stripes]; }
+
+  static size_t round_up_size(size_t bucket_count) {
+    size_t size = num_stripes;
+    while (size < bucket_count)
+      size <<= 1;
+    return size;
+  }
+
+  // Returns the bucket that currently holds the nodes for hash. The
+  // caller must hold the stripe lock of hash.
+  std::atomic<node*>& locked_bucket(size_t hash, table*& t) {
+    t = _table.load();
+    while (t->bucket(hash).load() == moved())
+      t = t->_next.load();
+    return t->bucket(hash);
+  }
+
+  // Finds the link that points to the node with key in bucket. The caller
+  // must hold the stripe lock of the bucket.
+  std::atomic<node*>* locked_find(std::atomic<node*>& bucket, size_t hash,
+                                  Key const& key) {
+    std::atomic<node*>* link = &bucket;
+    for (node* n = link->load(); n != nullptr; n = link->load()) {
+      if (n->_hash == hash && _key_equal(n->_key, key))
+        return link;
+      link = &n->_next;
+    }
+    return link;
+  }
+
+  // Unlinks the node *link points to, replacing it by replacement (which
+  // may be the successor of the node), and retires the node. The caller
+  // must hold the stripe lock of the bucket.
+  void locked_replace(std::atomic<node*>* link, node* replacement) {
+    node* n = link->load();
+    n->_next.store(marked(n->_next.load()));
+    link->store(replacement);
+    _rec.retireNode(n);
+  }
+
+  void start_resize(table* t) {
+    if (_table.load() != t || t->_next.load() != nullptr)
+      return;
+    table* expected = nullptr;
+    table* next = new table(2 * t->size());
+    if (!t->_next.compare_exchange_strong(expected, next))
+      delete next;
+  }
+
+  void migrate(table* t, table* next, size_t b) {
+    {
+      std::lock_guard<mare::internal::mutex> lock(_stripes[b % num_stripes]
+                                                  ._lock);
+      std::atomic<node*>& bucket = t->_buckets[b];
+      node* head = bucket.load();
+      for (node* n = head; n != nullptr; n = n->_next.load()) {
+        std::atomic<node*>& target = next->bucket(n->_hash);
+        target.store(new node(n->_key, n->_value, n->_hash, target.load()));
+      }
+      bucket.store(moved());
+      while (head != nullptr) {
+        node* n = head;
+        head = n->_next.load();
+        n->_next.store(marked(head));
+        _rec.retireNode(n);
+      }
+    }
+    if (t->_migrated.fetch_add(1) + 1 == t->size())
+      _table.store(next);
+  }
+
+  void help_resize() {
+    table* t = _table.load();
+    table* next = t->_next.load();
+    if (next == nullptr)
+      return;
+    for (size_t i = 0; i < migrate_per_write; ++i) {
+      size_t b = t->_cursor.fetch_add(1);
+      if (b >= t->size())
+        return;
+      migrate(t, next, b);
+    }
+  }
+
+  // Protects head of bucket. Returns nullptr if the bucket is empty
+  // or has moved, in which case t is advanced to the next table.
+  node* protect_head(size_t hash, table*& t, bool& retry) const {
+    for (;;) {
+      std::atomic<node*>& bucket = t->bucket(hash);
+      node* head = bucket.load();
+      if (head == moved()) {
+        t = t->_next.load();
+        retry = true;
+        return nullptr;
+      }
+      _rec.protect(0, head);
+      if (!reclamation_domain::validates || bucket.load() == head) {
+        retry = false;
+        return head;
+      }
+    }
+  }
+
+public:
+  explicit concurrent_hash_map(size_t bucket_count) :
+    _hash(),
+    _key_equal(),
+    _first(new table(round_up_size(bucket_count))),
+    _table(_first),
+    _stripes(),
+    _rec(reclamation_domain::shared()) {}
+
+  // Nodes that have been retired are left to the shared domain, which
+  // deletes them once no reader of any map can reach them anymore.
+  ~concurrent_hash_map() {
+    // Buckets that have not been migrated yet still own their nodes,
+    // even if a resize is in progress.
+    table* t = _first;
+    while (t != nullptr) {
+      for (size_t b = 0; b < t->size(); ++b) {
+        node* n = t->_buckets[b].load();
+        if (n == moved())
+          continue;
+        while (n != nullptr) {
+          node* next = n->_next.load();
+          delete n;
+          n = next;
+        }
+      }
+      table* next = t->_next.load();
+      delete t;
+      t = next;
+    }
+  }
+
+  MARE_DELETE_METHOD(concurrent_hash_map());
+  MARE_DELETE_METHOD(concurrent_hash_map(concurrent_hash_map const&));
+  MARE_DELETE_METHOD(concurrent_hash_map& operator=(
+                       concurrent_hash_map const&));
+
+  // Calls f(value) on the value of key, if present, while the node holding
+  // it is protected. Returns whether key was present.
+  template<typename F>
+  bool visit(Key const& key, F&& f) const {
+    _rec.threadInitAuto();
+    reclamation_section<reclamation_domain> section(_rec);
+    size_t hash = _hash(key);
+    table* t = _table.load();
+    for (;;) {
+      bool retry;
+      node* n = protect_head(hash, t, retry);
+      if (retry)
+        continue;
+
+      int slot = 0;
+      while (n != nullptr) {
+        if (n->_hash == hash && _key_equal(n->_key, key)) {
+          f(n->_value);
+          _rec.clear(0);
+          _rec.clear(1);
+          return true;
+        }
+        node* next = n->_next.load();
+        if (is_marked(next))
+          break;
+        _rec.protect(1 - slot, next);
+        if (reclamation_domain::validates && n->_next.load() != next)
+          break;
+        slot = 1 - slot;
+        n = next;
+      }
+
+      if (n == nullptr) {
+        _rec.clear(0);
+        _rec.clear(1);
+        return false;
+      }
+      // n was unlinked while we were looking at it; start over
+    }
+  }
+
+  // Returns true if value was inserted, false if key was present. In the
+  // latter case, the value of key is replaced by value iff assign.
+  bool insert(Key const& key, T const& value, bool assign) {
+    _rec.threadInitAuto();
+    size_t hash = _hash(key);
+    stripe& s = stripe_of(hash);
+    bool inserted;
+    table* t;
+    {
+      std::lock_guard<mare::internal::mutex> lock(s._lock);
+      std::atomic<node*>& bucket = locked_bucket(hash, t);
+      std::atomic<node*>* link = locked_find(bucket, hash, key);
+      node* n = link->load();
+      inserted = (n == nullptr);
+      if (inserted) {
+        bucket.store(new node(key, value, hash, bucket.load()));
+        s._count.fetch_add(1);
+      } else if (assign) {
+        locked_replace(link, new node(key, value, hash, n->_next.load()));
+      }
+    }
+    if (inserted && s._count.load() > t->size() / num_stripes)
+      start_resize(t);
+    help_resize();
+    return inserted;
+  }
+
+  bool erase(Key const& key) {
+    _rec.threadInitAuto();
+    size_t hash = _hash(key);
+    stripe& s = stripe_of(hash);
+    bool erased;
+    {
+      std::lock_guard<mare::internal::mutex> lock(s._lock);
+      table* t;
+      std::atomic<node*>& bucket = locked_bucket(hash, t);
+      std::atomic<node*>* link = locked_find(bucket, hash, key);
+      node* n = link->load();
+      erased = (n != nullptr);
+      if (erased) {
+        locked_replace(link, n->_next.load());
+        s._count.fetch_sub(1);
+      }
+    }
+    help_resize();
+    return erased;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (auto& s : _stripes)
+      size += s._count.load();
+    return size;
+  }
+
+  size_t bucket_count() const { return _table.load()->size(); }
+};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual,
+         typename Reclamation>
+const size_t
+concurrent_hash_map<Key, T, Hash, KeyEqual, Reclamation>::num_stripes;
+
+template<typename Key, typename T, typename Hash, typename KeyEqual,
+         typename Reclamation>
+const size_t
+concurrent_hash_map<Key, T, Hash, KeyEqual, Reclamation>::migrate_per_write;
+
+} //namespace internal
+
+} //namespace mare
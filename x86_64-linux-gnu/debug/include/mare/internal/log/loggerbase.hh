@@ -14,6 +14,8 @@
 // --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
 #pragma once
 
+#include <type_traits>
+
 #include <mare/internal/log/events.hh>
 #include <mare/internal/log/objectid.hh>
 
@@ -32,6 +34,32 @@ namespace log {
     virtual ~logger_base(){}
   };
 
+  /**
+     Whether logger L needs task and group ids. By default, every
+     enabled logger does, and enabling any of them switches
+     task_id and group_id from null_object_id to seq_object_id.
+
+     Loggers that identify objects by their address specialize
+     this template to std::false_type. They can be enabled
+     without changing the layout of task and group, which is fixed
+     by the prebuilt library.
+  */
+  template<typename L>
+  struct needs_object_ids :
+    public std::integral_constant<bool, L::enabled::value> { };
+
+  /**
+     Whether logger L logs as soon as the logging infrastructure is
+     active. By default, every enabled logger does.
+
+     Loggers that are compiled in so that they can be switched on at
+     runtime specialize this template to std::false_type unless their
+     MARE_USE_* macro is defined. See infrastructure::set_loggers().
+  */
+  template<typename L>
+  struct enabled_by_default :
+    public std::integral_constant<bool, L::enabled::value> { };
+
 } //mare::log
 } //mare::internal
 } //mare
@@ -57,6 +85,9 @@ namespace log {
 //   typedef std::true_type enabled;
 // #endif
 //
+//   // Name used to enable the logger at runtime
+//   static const char* get_name() { return "my_logger"; }
+//
 //   static void log(task_destroyed&& event, event_context& context) {
 //   ...
 //   }
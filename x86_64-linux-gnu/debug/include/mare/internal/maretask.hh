@@ -91,7 +91,9 @@ struct mare_task_nullary : public task {
   virtual ~mare_task_nullary() = 0;
 
   virtual void execute() {
+    log::log_event(log::events::task_executes(this));
     _f();
+    log::log_event(log::events::task_done(this));
   }
 
   virtual void cancel_notify(){
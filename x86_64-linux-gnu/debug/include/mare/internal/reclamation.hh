@@ -0,0 +1,126 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <mare/internal/epochreclamation.hh>
+#include <mare/internal/hazardpointers.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Memory reclamation policies
+///
+/// Containers that unlink nodes while other threads may still read them
+/// take a reclamation domain as a template policy. Both domains provide
+///  - threadInitAuto(): sets up the calling thread
+///  - enter()/exit():   bracket a read-side critical section
+///  - protect(slot, n): makes n safe to dereference within the critical
+///                      section; the caller has to re-check afterwards
+///                      that n is still reachable iff validates is true
+///  - clear(slot):      undoes protect(slot, n)
+///  - retireNode(n):    deletes n once no reader can reach it anymore
+///
+/// hazard_pointer_domain protects each node individually; enter() and
+/// exit() are no-ops. epoch_domain protects everything within a critical
+/// section; protect() and clear() are no-ops and need no re-check.
+///
+/// Containers use the domain returned by shared(), one per node type,
+/// rather than one domain each: the records of the threads are then
+/// allocated once instead of once per container, and the nodes a
+/// container retired may outlive it. The shared domain is never
+/// destroyed.
+
+template<typename TN, int K>
+class hazard_pointer_domain {
+private:
+  hp::Manager<TN, K> _manager;
+
+public:
+  static const bool validates = true;
+
+  hazard_pointer_domain() : _manager() {}
+
+  MARE_DELETE_METHOD(hazard_pointer_domain(hazard_pointer_domain const&));
+  MARE_DELETE_METHOD(hazard_pointer_domain& operator=(
+                       hazard_pointer_domain const&));
+
+  static hazard_pointer_domain& shared() {
+    static hazard_pointer_domain* s_domain = new hazard_pointer_domain();
+    return *s_domain;
+  }
+
+  void threadInitAuto() { _manager.threadInitAuto(); }
+  void enter() {}
+  void exit() {}
+  void protect(size_t slot, TN* n) { _manager.setMySlot(slot, n); }
+  void clear(size_t slot) { _manager.clearMySlot(slot); }
+  void retireNode(TN* n) { _manager.retireNode(n); }
+};
+
+template<typename TN, int K>
+const bool hazard_pointer_domain<TN, K>::validates;
+
+template<typename TN, int K>
+class epoch_domain {
+private:
+  ebr::Manager<TN> _manager;
+
+public:
+  static const bool validates = false;
+
+  epoch_domain() : _manager() {}
+
+  MARE_DELETE_METHOD(epoch_domain(epoch_domain const&));
+  MARE_DELETE_METHOD(epoch_domain& operator=(epoch_domain const&));
+
+  static epoch_domain& shared() {
+    static epoch_domain* s_domain = new epoch_domain();
+    return *s_domain;
+  }
+
+  void threadInitAuto() { _manager.threadInitAuto(); }
+  void enter() { _manager.enter(); }
+  void exit() { _manager.exit(); }
+  void protect(size_t, TN*) {}
+  void clear(size_t) {}
+  void retireNode(TN* n) { _manager.retireNode(n); }
+};
+
+template<typename TN, int K>
+const bool epoch_domain<TN, K>::validates;
+
+/// Keeps the calling thread inside a critical section of domain for the
+/// lifetime of the object
+template<typename Domain>
+class reclamation_section {
+private:
+  Domain& _domain;
+
+public:
+  explicit reclamation_section(Domain& domain) : _domain(domain) {
+    _domain.enter();
+  }
+
+  ~reclamation_section() { _domain.exit(); }
+
+  MARE_DELETE_METHOD(reclamation_section(reclamation_section const&));
+  MARE_DELETE_METHOD(reclamation_section& operator=(
+                       reclamation_section const&));
+};
+
+} //namespace internal
+
+} //namespace mare
@@ -22,6 +22,7 @@
 namespace mare{
 /** @cond */
 typedef internal::mutex mutex;
+typedef internal::queued_mutex queued_mutex;
 typedef internal::timed_lock<mare::mutex> timed_mutex;
 typedef internal::recursive_lock<mare::mutex> recursive_mutex;
 typedef internal::timed_lock<mare::recursive_mutex> recursive_timed_mutex;
@@ -75,6 +76,49 @@ public:
   void unlock();
 };
 
+/**
+    Mutex for locks under heavy contention.
+
+    A task that cannot acquire the mutex after a short spin with
+    exponential backoff joins a FIFO queue of waiters. Only the task at the
+    head of the queue polls the mutex; the others wait on a flag of their
+    own, so a release does not make every waiter retry at once. Waiting
+    tasks eventually block without blocking the MARE scheduler. Use it
+    instead of mare::mutex for locks that many tasks contend for.
+
+    The mutex is not fair: a task that arrives while the mutex is free may
+    acquire it ahead of the queued waiters.
+*/
+class queued_mutex{
+public:
+
+  /** Default constructor. Initializes to not locked. */
+  queued_mutex();
+
+  queued_mutex(queued_mutex&) = delete;
+  queued_mutex(queued_mutex&&) = delete;
+  queued_mutex& operator=(queued_mutex const&) = delete;
+
+  /**
+      Acquires the mutex, waits if the mutex is not available.
+
+      May yield to the MARE scheduler.
+  */
+  void lock();
+
+  /**
+      Attempts to acquire the mutex. Does not wait.
+
+      @return
+      TRUE -- Successfully acquired the mutex.\n
+      FALSE -- Did not acquire the mutex.
+  */
+  bool try_lock();
+
+  /** Releases the mutex and wakes up the head of the queue if it blocked. */
+  void unlock();
+};
+
 /**
     Provides wait/wakeup capabilities for implementing
     synchronization primitives.
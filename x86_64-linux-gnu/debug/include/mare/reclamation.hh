@@ -0,0 +1,60 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file reclamation.hh */
+#pragma once
+
+#include <mare/internal/reclamation.hh>
+
+namespace mare {
+
+/** @addtogroup reclamation
+@{ */
+/**
+   Selects hazard pointers to reclaim the memory of elements removed from
+   a concurrent container.
+
+   Readers publish every element they access, and fence each time. The
+   memory of removed elements is reclaimed promptly, even if a reader is
+   stalled.
+*/
+struct hazard_pointer_reclamation {
+  /** @cond */
+  template<typename TN, int K>
+  struct domain {
+    typedef internal::hazard_pointer_domain<TN, K> type;
+  };
+  /** @endcond */
+};
+
+/**
+   Selects epoch-based reclamation to reclaim the memory of elements
+   removed from a concurrent container.
+
+   Readers only announce the start and end of each operation, which makes
+   reads cheaper than with hazard_pointer_reclamation. A reader that is
+   stalled inside an operation delays the reclamation of all removed
+   elements, though.
+*/
+struct epoch_based_reclamation {
+  /** @cond */
+  template<typename TN, int K>
+  struct domain {
+    typedef internal::epoch_domain<TN, K> type;
+  };
+  /** @endcond */
+};
+/** @} */ /* end_addtogroup reclamation */
+
+} // namespace mare
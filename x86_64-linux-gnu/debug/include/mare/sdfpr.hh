@@ -182,7 +182,7 @@ template<typename T>
 tuple_dir_channel as_in_channel_tuple(data_channel<T>& dc)
 {
   return std::make_tuple(internal::direction::in,
-                         dynamic_cast<channel*>(&dc));
+                         static_cast<channel*>(&dc));
 }
 
 /**
@@ -201,7 +201,7 @@ template<typename T>
 tuple_dir_channel as_out_channel_tuple(data_channel<T>& dc)
 {
   return std::make_tuple(internal::direction::out,
-                         dynamic_cast<channel*>(&dc));
+                         static_cast<channel*>(&dc));
 }
 
 
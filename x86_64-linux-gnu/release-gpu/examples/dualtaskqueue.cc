@@ -0,0 +1,136 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/internal/dualtaskqueue.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. measure the push/pop throughput of the internal DualTaskQueue, the
+//     queue used for task queues and blocked tasks, and
+//  2. when built with MARE_DQ_NODE_CACHE, report how many of its node
+//     allocations are served from the per-thread node cache instead of
+//     malloc.
+//
+//  The first benchmark pushes and pops num_elements elements from a single
+//  thread, depth elements at a time, so it only measures the cost of the
+//  queue operations and of their node allocations. The second one runs
+//  num_pairs producer threads and as many consumer threads; consumers
+//  block in pop() while the queue is empty, as the MARE worker threads do.
+//
+//  The node cache speeds up the first benchmark, but slows down the
+//  second one: a producer fills the queue for a whole time slice, and
+//  that many nodes do not fit in the cache.
+
+typedef mare::internal::DualTaskQueue<std::size_t> queue;
+#ifdef MARE_DQ_NODE_CACHE
+typedef mare::internal::node_cache<queue::qnode> qnode_cache;
+#endif
+
+const std::size_t num_elements = 1 << 20;
+const std::size_t depth        = 256;
+
+// Returns the throughput, in operations/s
+double
+run_single()
+{
+  queue q;
+  q.threadInitAuto();
+  mare::internal::paired_mutex_cv synch;
+
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t round = 0; round < num_elements / depth; round++) {
+    for (std::size_t i = 0; i < depth; i++)
+      q.push(i, false);
+    for (std::size_t i = 0; i < depth; i++) {
+      std::size_t v;
+      bool popped = q.popIf([] { return false; }, v, &synch);
+      assert(popped && v == i);
+      MARE_UNUSED(popped);
+      MARE_UNUSED(v);
+    }
+  }
+  auto end = std::chrono::system_clock::now();
+
+  q.threadFinish();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(2 * num_elements) / seconds;
+}
+
+// Returns the throughput, in operations/s
+double
+run_pairs(std::size_t num_pairs)
+{
+  queue q;
+  std::size_t per_thread = num_elements / num_pairs;
+
+  std::vector<std::thread> threads;
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t p = 0; p < num_pairs; p++) {
+    threads.push_back(std::thread([&q, per_thread] {
+          q.threadInitAuto();
+          for (std::size_t i = 0; i < per_thread; i++)
+            q.push(i);
+          q.threadFinish();
+        }));
+    threads.push_back(std::thread([&q, per_thread] {
+          q.threadInitAuto();
+          mare::internal::paired_mutex_cv synch;
+          for (std::size_t i = 0; i < per_thread; i++) {
+            std::size_t v;
+            bool popped = q.pop(v, &synch);
+            assert(popped);
+            MARE_UNUSED(popped);
+          }
+          q.threadFinish();
+        }));
+  }
+  for (auto& t : threads)
+    t.join();
+  auto end = std::chrono::system_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(2 * per_thread * num_pairs) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  double single = run_single();
+  MARE_LLOG("single thread: %14.1f ops/s", single);
+#ifdef MARE_DQ_NODE_CACHE
+  qnode_cache::stats s = qnode_cache::thread_stats();
+  MARE_LLOG("  node cache: %zu hits, %zu refills, %zu mallocs, %zu spills",
+            s._hits, s._refills, s._misses, s._spills);
+#endif
+
+  MARE_LLOG("pairs      push+pop");
+  for (std::size_t num_pairs = 1; num_pairs <= 4; num_pairs *= 2)
+    MARE_LLOG("%-5zu %14.1f ops/s", num_pairs, run_pairs(num_pairs));
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <chrono>
+#include <cstddef>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/schedulerstorage.hh>
+#include <mare/taskstorage.hh>
+#include <mare/threadstorage.hh>
+
+///////////////
+//
+//  Goal is to
+//  measure the cost of dereferencing task_storage_ptr,
+//  scheduler_storage_ptr and thread_storage_ptr from within a task,
+//  compared to a thread_local variable.
+//
+//  Each loop reads its storage num_reads times and adds up the values,
+//  so that the compiler cannot hoist the lookup out of the loop; the
+//  empty asm statement makes every iteration look up the storage
+//  again.
+
+const std::size_t num_reads = 20000000;
+
+static thread_local std::size_t* s_thread_local;
+mare::task_storage_ptr<std::size_t> s_task_storage;
+const mare::scheduler_storage_ptr<std::size_t> s_scheduler_storage;
+const mare::thread_storage_ptr<std::size_t> s_thread_storage;
+
+template<typename Lookup>
+void
+measure(const char* name, Lookup&& lookup)
+{
+  std::size_t sum = 0;
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t i = 0; i < num_reads; i++) {
+    sum += *lookup();
+    asm volatile("" ::: "memory");
+  }
+  auto end = std::chrono::system_clock::now();
+
+  MARE_INTERNAL_ASSERT(sum == num_reads, "wrong sum %zu", sum);
+  MARE_LLOG("%-24s %6.2f ns", name,
+            std::chrono::duration<double, std::nano>(end - start).count() /
+            num_reads);
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  auto t = mare::create_task([] {
+      std::size_t one = 1;
+      s_thread_local = &one;
+      s_task_storage = &one;
+      *s_scheduler_storage = 1;
+      *s_thread_storage = 1;
+
+      MARE_LLOG("%-24s %9s", "storage", "lookup");
+      measure("thread_local", [] { return s_thread_local; });
+      measure("task_storage_ptr", [] { return s_task_storage.get(); });
+      measure("scheduler_storage_ptr",
+              [] { return s_scheduler_storage.get(); });
+      measure("thread_storage_ptr", [] { return s_thread_storage.get(); });
+    });
+  mare::launch(t);
+  mare::wait_for(t);
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
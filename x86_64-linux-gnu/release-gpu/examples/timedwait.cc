@@ -0,0 +1,61 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mare/mare.h>
+
+using namespace std;
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate how to bound the time spent waiting for a group with
+//     mare::wait_for(group, timeout), and
+//  2. cancel the work that did not finish in time.
+
+// Counts the number of tasks that execute before the deadline
+atomic<size_t> counter;
+
+int main() {
+
+  // Initialize the MARE runtime.
+  mare::runtime::init();
+  auto group = mare::create_group();
+
+  // Create 2000 tasks, which together take much longer than we can wait.
+  for (int i = 0; i < 2000; i++){
+    mare::launch(group, [] {
+        counter++;
+        usleep(100);
+      });
+  }
+
+  // Wait for at most 20 milliseconds. wait_for does not cancel the group
+  // on timeout; it only reports whether the group finished.
+  if (mare::wait_for(group, chrono::milliseconds(20)) == false) {
+    MARE_ALOG("timed out after %zu tasks executed", counter.load());
+    mare::cancel(group);
+    mare::wait_for(group);
+  }
+  MARE_ALOG("group done after %zu tasks executed", counter.load());
+
+  // Shutdown the MARE runtime.
+  mare::runtime::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Lock-free multi-producer, single-consumer queue.
+///
+/// Producers push onto a Treiber stack with a single CAS. The consumer
+/// takes the whole stack with one exchange, reverses it into a private
+/// list in FIFO order, and serves try_pop_n() from that list without any
+/// atomic operation until it is exhausted. Producers therefore only
+/// contend with each other on _head, and the consumer touches _head once
+/// per batch rather than once per element.
+///
+/// Since the consumer never removes single nodes from _head, the ABA
+/// problem of Treiber stacks cannot occur: a push only ever links its
+/// node in front of whatever node is the head at the time of its CAS.
+///
+/// Nodes are allocated with operator new rather than from a node_cache:
+/// injection queues can grow deep, and then nodes recycled out of order
+/// make the consumer's walk over the list slower than fresh memory.
+template<typename T>
+class mpsc_queue {
+private:
+  struct node {
+    node* _next;
+    T _value;
+
+    node(T const& value, node* next) : _next(next), _value(value) {}
+
+    MARE_DELETE_METHOD(node(node const&));
+    MARE_DELETE_METHOD(node& operator=(node const&));
+
+  };
+
+  static const size_t cache_line_size = 64;
+
+  char _pad0[cache_line_size];
+  std::atomic<node*> _head;
+  char _pad1[cache_line_size - sizeof(std::atomic<node*>)];
+  // Owned by the consumer
+  node* _private;
+  char _pad2[cache_line_size - sizeof(node*)];
+
+  void take_all() {
+    node* n = _head.exchange(nullptr, std::memory_order_acquire);
+    node* reversed = nullptr;
+    while (n != nullptr) {
+      node* next = n->_next;
+      n->_next = reversed;
+      reversed = n;
+      n = next;
+    }
+    _private = reversed;
+  }
+
+public:
+  mpsc_queue() :
+    _pad0(),
+    _head(nullptr),
+    _pad1(),
+    _private(nullptr),
+    _pad2() {}
+
+  MARE_DELETE_METHOD(mpsc_queue(mpsc_queue const&));
+  MARE_DELETE_METHOD(mpsc_queue& operator=(mpsc_queue const&));
+
+  ~mpsc_queue() {
+    delete_list(_private);
+    delete_list(_head.load());
+  }
+
+  /// Can be called by any thread.
+  void push(T const& value) {
+    node* n = new node(value, _head.load(std::memory_order_relaxed));
+    while (!_head.compare_exchange_weak(n->_next, n,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {}
+  }
+
+  /// Pops up to max_elements elements, in the order they were pushed by
+  /// each producer, and writes them to out. Must only be called by the
+  /// consumer.
+  ///
+  /// @return The number of elements popped.
+  template<typename OutputIterator>
+  size_t try_pop_n(OutputIterator out, size_t max_elements) {
+    if (_private == nullptr)
+      take_all();
+    size_t popped = 0;
+    while (popped < max_elements && _private != nullptr) {
+      node* n = _private;
+      _private = n->_next;
+      *out = n->_value;
+      ++out;
+      delete n;
+      ++popped;
+    }
+    return popped;
+  }
+
+  /// Exact if called by the consumer while no producer pushes.
+  bool empty() const {
+    return _private == nullptr &&
+      _head.load(std::memory_order_relaxed) == nullptr;
+  }
+
+private:
+  static void delete_list(node* n) {
+    while (n != nullptr) {
+      node* next = n->_next;
+      delete n;
+      n = next;
+    }
+  }
+};
+
+template<typename T>
+const size_t mpsc_queue<T>::cache_line_size;
+
+/// Injection queue for elements pushed by threads outside of MARE.
+///
+/// Consists of one mpsc_queue per consumer (e.g., per worker thread).
+/// Producers pick a shard either explicitly by a key, or by a hash of
+/// their thread id, so that a producer keeps pushing to the same shard
+/// and producers spread over all shards. Each consumer drains its own
+/// shard in batches with try_pop_n().
+template<typename T>
+class injection_queue {
+private:
+  size_t _num_shards;
+  std::unique_ptr<mpsc_queue<T>[]> _shards;
+
+  static size_t thread_key() {
+    return std::hash<std::thread::id>()(std::this_thread::get_id());
+  }
+
+public:
+  explicit injection_queue(size_t num_shards) :
+    _num_shards(num_shards),
+    _shards(new mpsc_queue<T>[num_shards]) {
+    MARE_API_ASSERT(num_shards > 0, "injection_queue needs a shard");
+  }
+
+  MARE_DELETE_METHOD(injection_queue(injection_queue const&));
+  MARE_DELETE_METHOD(injection_queue& operator=(injection_queue const&));
+
+  size_t num_shards() const { return _num_shards; }
+
+  /// Pushes to the shard of the calling thread.
+  void push(T const& value) {
+    push(value, thread_key());
+  }
+
+  /// Pushes to shard key % num_shards(), e.g., for round-robin pushes.
+  void push(T const& value, size_t key) {
+    _shards[key % _num_shards].push(value);
+  }
+
+  /// Must only be called by the consumer of shard.
+  template<typename OutputIterator>
+  size_t try_pop_n(size_t shard, OutputIterator out, size_t max_elements) {
+    MARE_INTERNAL_ASSERT(shard < _num_shards, "shard out of range");
+    return _shards[shard].try_pop_n(out, max_elements);
+  }
+
+  /// Exact if called by the consumer of shard while no producer pushes.
+  bool empty(size_t shard) const {
+    return _shards[shard].empty();
+  }
+};
+
+} //namespace internal
+
+} //namespace mare
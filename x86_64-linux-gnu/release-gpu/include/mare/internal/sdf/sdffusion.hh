@@ -0,0 +1,208 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file sdffusion.hh */
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mare {
+namespace internal {
+
+  /// Node Fusion
+  ///
+  /// A linear chain of nodes
+  ///      f1 -> (dc) -> f2
+  /// where dc is connected only between f1 and f2 and carries no preloaded
+  /// delays, fires exactly once per graph iteration for each node. The chain
+  /// can therefore be replaced by a single node whose body invokes f1 and
+  /// then f2 on the same graph iteration, with the value of dc held in a
+  /// local variable of the fused body instead of a channel buffer.
+  ///
+  /// Since the fused node is an ordinary SDF node, pause/resume/cancel
+  /// semantics are unchanged: a graph iteration of the fused node is
+  /// exactly one graph iteration of each of the original nodes, and the
+  /// fused body is never interrupted between f1 and f2.
+  ///
+  /// The mechanisms below compute the type signature of the fused body
+  /// purely via compile-time templates:
+  ///  - sdf_body_traits: extracts the parameter types of a body.
+  ///  - fused_sdf_body:  the fused callable, whose operator() has the
+  ///                     parameters of f1 minus its last parameter,
+  ///                     followed by the parameters of f2 minus its first.
+
+  /// sdf_body_traits:
+  /// param_types = std::tuple of the parameter types of the body, with
+  /// references removed.
+
+template<typename F>
+struct sdf_body_traits :
+  public sdf_body_traits<decltype(&F::operator())> { };
+
+template<typename R, typename ...As>
+struct sdf_body_traits<R(As...)> {
+  typedef std::tuple<typename std::remove_reference<As>::type...> param_types;
+};
+
+template<typename R, typename ...As>
+struct sdf_body_traits<R(*)(As...)> :
+  public sdf_body_traits<R(As...)> { };
+
+template<typename R, typename ...As>
+struct sdf_body_traits<R(&)(As...)> :
+  public sdf_body_traits<R(As...)> { };
+
+template<typename R, typename C, typename ...As>
+struct sdf_body_traits<R(C::*)(As...)> :
+  public sdf_body_traits<R(As...)> { };
+
+template<typename R, typename C, typename ...As>
+struct sdf_body_traits<R(C::*)(As...) const> :
+  public sdf_body_traits<R(As...)> { };
+
+  /// tuple_split_last:
+  /// init = all but the last element type, last = the last element type
+
+template<typename TT>
+struct tuple_split_last;
+
+template<typename T>
+struct tuple_split_last< std::tuple<T> > {
+  typedef std::tuple<> init;
+  typedef T            last;
+};
+
+template<typename T, typename U, typename ...Ts>
+struct tuple_split_last< std::tuple<T, U, Ts...> > {
+  typedef typename tuple_split_last< std::tuple<U, Ts...> >::last last;
+  typedef decltype( std::tuple_cat(
+                      std::declval< std::tuple<T> >(),
+                      std::declval< typename tuple_split_last<
+                                      std::tuple<U, Ts...> >::init >() ) )
+          init;
+};
+
+  /// tuple_split_first:
+  /// first = the first element type, rest = all but the first element type
+
+template<typename TT>
+struct tuple_split_first;
+
+template<typename T, typename ...Ts>
+struct tuple_split_first< std::tuple<T, Ts...> > {
+  typedef T                  first;
+  typedef std::tuple<Ts...>  rest;
+};
+
+  /// fused_sdf_body:
+  ///   F1 is invoked as f1(ls..., mid), F2 as f2(mid, rs...).
+  ///   mid is a local of operator(), i.e., lives on the stack of the firing.
+  ///   Mid must therefore be default-constructible.
+
+template<typename F1, typename F2, typename Mid, typename Ls, typename Rs>
+class fused_sdf_body;
+
+template<typename F1, typename F2, typename Mid,
+         typename ...Ls, typename ...Rs>
+class fused_sdf_body<F1, F2, Mid, std::tuple<Ls...>, std::tuple<Rs...> > {
+  F1 _f1;
+  F2 _f2;
+
+public:
+  fused_sdf_body(F1 const& f1, F2 const& f2) :
+    _f1(f1),
+    _f2(f2) { }
+
+  void operator()(Ls&... ls, Rs&... rs)
+  {
+    Mid mid;
+    _f1(ls..., mid);
+    _f2(mid, rs...);
+  }
+};
+
+template<typename F1, typename F2>
+struct fused_sdf_body_type {
+  typedef typename sdf_body_traits<F1>::param_types f1_params;
+  typedef typename sdf_body_traits<F2>::param_types f2_params;
+
+  static_assert(std::tuple_size<f1_params>::value >= 1,
+                "upstream body must have an out-parameter to fuse on");
+  static_assert(std::tuple_size<f2_params>::value >= 1,
+                "downstream body must have an in-parameter to fuse on");
+
+  typedef typename tuple_split_last<f1_params>::last   f1_out;
+  typedef typename tuple_split_first<f2_params>::first f2_in;
+
+  static_assert(std::is_same<f1_out, f2_in>::value,
+                "last parameter of upstream body and first parameter of "
+                "downstream body must carry the same user-data-type");
+
+  typedef fused_sdf_body<F1,
+                         F2,
+                         f1_out,
+                         typename tuple_split_last<f1_params>::init,
+                         typename tuple_split_first<f2_params>::rest> type;
+};
+
+  /// fused_sdf_chain_type:
+  /// type of the body fusing the chain F1 -> F2 -> Fs..., left to right.
+  /// Bodies passed as plain functions decay to function pointers.
+template<typename F1, typename F2, typename ...Fs>
+struct fused_sdf_chain_type {
+  typedef typename fused_sdf_chain_type<
+                     typename fused_sdf_chain_type<F1, F2>::type,
+                     Fs...>::type type;
+};
+
+template<typename F1, typename F2>
+struct fused_sdf_chain_type<F1, F2> {
+  typedef typename fused_sdf_body_type<
+                     typename std::decay<F1>::type,
+                     typename std::decay<F2>::type>::type type;
+};
+
+template<typename F1, typename F2>
+typename fused_sdf_chain_type<F1, F2>::type
+fuse_sdf_bodies_chain(F1&& f1, F2&& f2)
+{
+  return typename fused_sdf_chain_type<F1, F2>::type(f1, f2);
+}
+
+template<typename F1, typename F2, typename F3, typename ...Fs>
+typename fused_sdf_chain_type<F1, F2, F3, Fs...>::type
+fuse_sdf_bodies_chain(F1&& f1, F2&& f2, F3&& f3, Fs&&... fs)
+{
+  return fuse_sdf_bodies_chain(
+           fuse_sdf_bodies_chain(std::forward<F1>(f1), std::forward<F2>(f2)),
+           std::forward<F3>(f3),
+           std::forward<Fs>(fs)...);
+}
+
+} //namespace internal
+
+
+  /// See documentation in sdf.hh
+template<typename F1, typename F2, typename ...Fs>
+typename internal::fused_sdf_chain_type<F1, F2, Fs...>::type
+fuse_sdf_bodies(F1&& f1, F2&& f2, Fs&&... fs)
+{
+  return internal::fuse_sdf_bodies_chain(std::forward<F1>(f1),
+                                         std::forward<F2>(f2),
+                                         std::forward<Fs>(fs)...);
+}
+
+} //namespace mare
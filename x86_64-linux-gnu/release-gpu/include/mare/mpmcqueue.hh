@@ -0,0 +1,164 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file mpmcqueue.hh */
+#pragma once
+
+#include <iterator>
+#include <utility>
+
+#include <mare/internal/mpmcqueue.hh>
+
+namespace mare {
+
+/** @addtogroup mpmc_queue
+@{ */
+/**
+   Bounded multi-producer/multi-consumer FIFO queue.
+
+   Elements are stored in a ring of slots, each tagged with a sequence
+   number, so producers and consumers synchronize through per-slot atomics
+   rather than a lock.
+
+   The try_ operations never wait. push() and pop() wait while the queue is
+   full or empty, respectively, without blocking the MARE scheduler:
+   similar to mare::mutex, a waiting task first yields and then blocks in
+   MARE until another task pops or pushes an element.
+
+   The batch operations claim a run of consecutive slots at once, which
+   amortizes the synchronization cost over the batch.
+
+   @note1 The capacity is rounded up to the next power of two.
+   @note1 Move-assigning a T out of the queue must not throw. If
+   constructing a T in the queue throws, the exception is passed on to
+   the caller, and none of the elements of the failing batch from the
+   throwing one onwards is pushed.
+*/
+
+template<typename T>
+class mpmc_queue {
+public:
+  typedef T value_type;
+
+  /** @param capacity Minimum number of elements the queue can hold. */
+  explicit mpmc_queue(size_t capacity) :
+    _ring(capacity),
+    _not_full(),
+    _not_empty() {}
+
+  MARE_DELETE_METHOD(mpmc_queue(mpmc_queue const&));
+  MARE_DELETE_METHOD(mpmc_queue& operator=(mpmc_queue const&));
+
+  /** Pushes a copy of v unless the queue is full.
+      @return True if v was pushed; false if the queue was full. */
+  bool try_push(value_type const& v) { return pushed(_ring.try_push_n(&v, 1)); }
+
+  /** Pushes v by moving it unless the queue is full; v is left untouched
+      if the queue was full.
+      @return True if v was pushed; false if the queue was full. */
+  bool try_push(value_type&& v) {
+    return pushed(_ring.try_push_n(std::make_move_iterator(&v), 1));
+  }
+
+  /** Pops the oldest element into r unless the queue is empty.
+      @return True if an element was popped; false if the queue was
+      empty. */
+  bool try_pop(value_type& r) { return popped(_ring.try_pop_n(&r, 1)); }
+
+  /** Pushes up to n elements starting at first, stopping when the queue
+      is full. Use std::make_move_iterator to move elements into the
+      queue.
+      @return The number of elements pushed. */
+  template<typename ForwardIt>
+  size_t try_push_n(ForwardIt first, size_t n) {
+    return pushed(_ring.try_push_n(first, n));
+  }
+
+  /** Pops up to n elements into result, result + 1, ..., stopping when
+      the queue is empty.
+      @return The number of elements popped. */
+  template<typename OutputIt>
+  size_t try_pop_n(OutputIt result, size_t n) {
+    return popped(_ring.try_pop_n(result, n));
+  }
+
+  /** Pushes a copy of v, waiting while the queue is full.
+      May yield to the MARE scheduler. */
+  void push(value_type const& v) {
+    _not_full.wait_until([this, &v] { return try_push(v); });
+  }
+
+  /** Pushes v by moving it, waiting while the queue is full.
+      May yield to the MARE scheduler. */
+  void push(value_type&& v) {
+    _not_full.wait_until([this, &v] { return try_push(std::move(v)); });
+  }
+
+  /** Pops the oldest element into r, waiting while the queue is empty.
+      May yield to the MARE scheduler. */
+  void pop(value_type& r) {
+    _not_empty.wait_until([this, &r] { return try_pop(r); });
+  }
+
+  /** Pushes the n elements starting at first, waiting while the queue is
+      full. May yield to the MARE scheduler. */
+  template<typename ForwardIt>
+  void push_n(ForwardIt first, size_t n) {
+    _not_full.wait_until([this, &first, &n] {
+        size_t pushed = try_push_n(first, n);
+        std::advance(first, pushed);
+        n -= pushed;
+        return n == 0;
+      });
+  }
+
+  /** Pops n elements into result, result + 1, ..., waiting while the
+      queue is empty. May yield to the MARE scheduler. */
+  template<typename ForwardIt>
+  void pop_n(ForwardIt result, size_t n) {
+    _not_empty.wait_until([this, &result, &n] {
+        size_t popped = try_pop_n(result, n);
+        std::advance(result, popped);
+        n -= popped;
+        return n == 0;
+      });
+  }
+
+  /** Returns the number of elements the queue can hold. */
+  size_t capacity() const { return _ring.capacity(); }
+
+  /** Returns the number of elements in the queue. This is only a snapshot
+      if other tasks use the queue concurrently. */
+  size_t size() const { return _ring.size(); }
+
+private:
+  size_t pushed(size_t n) {
+    if (n > 0)
+      _not_empty.notify(n);
+    return n;
+  }
+
+  size_t popped(size_t n) {
+    if (n > 0)
+      _not_full.notify(n);
+    return n;
+  }
+
+  internal::mpmc_ring<T> _ring;
+  internal::mpmc_wait_list _not_full;
+  internal::mpmc_wait_list _not_empty;
+};
+
+} // namespace mare
+/** @} */ /* end_addtogroup mpmc_queue */
@@ -0,0 +1,96 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cassert>
+#include <chrono>
+#include <mutex>
+
+#include <mare/internal/debug.hh>
+#include <mare/mare.h>
+#include <mare/mutex.hh>
+
+///////////////
+//
+//  Goal is to
+//  1. illustrate the use of mare::queued_mutex, and
+//  2. compare it against mare::mutex under contention, for different
+//     numbers of tasks and lengths of the critical section.
+//
+//  Each benchmark launches num_tasks tasks that acquire the mutex
+//  num_locks times in total. Inside the critical section, a task
+//  increments a shared counter and performs cs_length units of work.
+
+const std::size_t num_locks = 1 << 18;
+
+// One unit of work that the compiler cannot optimize away
+volatile std::size_t s_sink;
+
+void
+work(std::size_t units)
+{
+  for (std::size_t i = 0; i < units; i++)
+    s_sink = s_sink + i;
+}
+
+// Returns the number of acquisitions per second
+template<typename Mutex>
+double
+run(std::size_t num_tasks, std::size_t cs_length)
+{
+  Mutex m;
+  std::size_t counter = 0;
+  std::size_t per_task = num_locks / num_tasks;
+
+  auto g = mare::create_group();
+  auto start = std::chrono::system_clock::now();
+  for (std::size_t t = 0; t < num_tasks; t++) {
+    mare::launch(g, [&m, &counter, per_task, cs_length] {
+        for (std::size_t i = 0; i < per_task; i++) {
+          std::lock_guard<Mutex> lock(m);
+          counter++;
+          work(cs_length);
+        }
+      });
+  }
+  mare::wait_for(g);
+  auto end = std::chrono::system_clock::now();
+
+  assert(counter == per_task * num_tasks);
+  MARE_UNUSED(counter);
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return double(per_task * num_tasks) / seconds;
+}
+
+int main()
+{
+  mare::runtime::init();
+
+  MARE_LLOG("tasks  cs_length     mare::mutex  mare::queued_mutex");
+  std::size_t const cs_lengths[] = {0, 64, 1024};
+  for (std::size_t num_tasks = 2; num_tasks <= 32; num_tasks *= 4) {
+    for (auto cs_length : cs_lengths) {
+      double plain = run<mare::mutex>(num_tasks, cs_length);
+      double queued = run<mare::queued_mutex>(num_tasks, cs_length);
+      MARE_LLOG("%-6zu %9zu %15.1f %19.1f locks/s (%.2fx)",
+                num_tasks, cs_length, plain, queued, queued / plain);
+    }
+  }
+
+  mare::runtime::shutdown();
+
+  return 0;
+}
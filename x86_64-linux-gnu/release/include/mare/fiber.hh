@@ -0,0 +1,109 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+/** @file fiber.hh */
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+#include <mare/attr.hh>
+#include <mare/group.hh>
+#include <mare/task.hh>
+
+#include <mare/internal/fiber.hh>
+
+namespace mare
+{
+
+/** @addtogroup execution
+@{ */
+/**
+    Creates a new task that runs on its own stack, and launches it into
+    a group.
+
+    A task launched with mare::launch_fiber runs on a user-level stack
+    (a fiber) taken from a pool. When the fiber waits with
+    <tt>mare::wait_for(task_ptr)</tt>,
+    <tt>mare::wait_for(group_ptr)</tt> or one of their timed variants,
+    it is suspended, and the worker thread runs other tasks until the
+    fiber can continue, possibly on another worker. A regular task that
+    waits instead keeps its worker busy. Use fibers for bodies that
+    spend most of their time waiting for other tasks.
+
+    The fiber counts as one task of <tt>group</tt> until its body
+    returns. Canceling the group does not interrupt a fiber that has
+    started; check mare::canceled(group_ptr const&) in the body to stop
+    early. Waits on mare::mutex and mare::condition_variable still
+    block the worker. Exceptions other than
+    mare::abort_task_exception must not escape the body.
+
+    Fibers have 256 KiB stacks with a guard page. Up to 64 stacks of
+    completed fibers are cached for reuse; the others are returned to
+    the system.
+
+    On Android, the C library has no support for fibers, and
+    mare::launch_fiber launches an ordinary task.
+
+    @param group Pointer to group.
+    @param body  Task body.
+
+    @throws api_exception If group points to null.
+
+    @par Example
+    @includelineno examples/fiberwait.cc
+
+    @sa mare::launch(group_ptr const&, Body&&)
+*/
+template<typename Body>
+inline void launch_fiber(group_ptr const& group, Body&& body)
+{
+  MARE_API_ASSERT(internal::c_ptr(group), "null group_ptr");
+#ifdef MARE_HAVE_FIBERS
+  auto done = create_task(with_attrs(
+                            create_task_attrs(internal::attr::non_cancelable),
+                            [] { }));
+  join_group(group, done);
+  auto f = new internal::fiber(std::function<void()>(
+                                 std::forward<Body>(body)),
+                               done);
+  f->start();
+#else
+  launch(group, std::forward<Body>(body));
+#endif
+}
+
+/**
+    Creates a new task that runs on its own stack, and launches it.
+
+    See mare::launch_fiber(group_ptr const&, Body&&).
+
+    @param body Task body.
+*/
+template<typename Body>
+inline void launch_fiber(Body&& body)
+{
+#ifdef MARE_HAVE_FIBERS
+  auto f = new internal::fiber(std::function<void()>(
+                                 std::forward<Body>(body)),
+                               nullptr);
+  f->start();
+#else
+  auto t = create_task(std::forward<Body>(body));
+  launch(t);
+#endif
+}
+/** @} */ /* end_addtogroup execution */
+
+} //namespace mare
@@ -0,0 +1,578 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mare/internal/cofdeque.hh>
+
+namespace mare {
+
+namespace internal {
+
+namespace cof {
+
+/// \brief Unbounded Concurrent Obstruction-Free containers
+///
+/// internal::cof::deque stores size_t values in an array whose size is
+/// fixed at creation time. The containers below lift both restrictions:
+///
+/// \li Values of any (possibly move-only) type T are stored in nodes
+///     handed out by a node_pool. The deque only ever stores the address
+///     of a node, so the fast size_t path of the deque is used for every
+///     T, and nodes are recycled instead of being allocated per push.
+///     Scalar values that fit in a size_t are stored in the deque
+///     directly.
+///
+/// \li The storage is a list of segments, each holding one deque. When
+///     the deque of the current segment is full, a new segment of twice
+///     the size (up to max_segment_size) is linked to it instead of
+///     failing the push.
+///
+/// queue_segments and stack_segments implement the segment list for
+/// FIFO and LIFO order, respectively. Both operate on batches of size_t
+/// values so that the bookkeeping needed to find the current segment is
+/// paid once per batch rather than once per value. unbounded<> combines
+/// one of them with a node_pool for T.
+
+/// Nodes are never handed back to the system while the pool is alive.
+/// Released nodes are kept in a bounded deque of free nodes, and only
+/// deleted if that deque is full.
+template<class T, class PREDICTOR>
+class node_pool {
+private:
+  struct node {
+    typename std::aligned_storage<sizeof(T),
+                                  std::alignment_of<T>::value>::type _storage;
+  };
+
+  static node* to_node(size_t v) { return reinterpret_cast<node*>(v); }
+
+  void recycle(node* n) {
+    if (!_free.right_push(reinterpret_cast<size_t>(n)))
+      delete n;
+  }
+
+  deque<PREDICTOR> _free;
+
+public:
+  explicit node_pool(size_t pool_size) : _free(pool_size) {}
+
+  ~node_pool() {
+    size_t v;
+    while (_free.right_pop(&v))
+      delete to_node(v);
+  }
+
+  MARE_DELETE_METHOD(node_pool());
+  MARE_DELETE_METHOD(node_pool(const node_pool&));
+  MARE_DELETE_METHOD(node_pool& operator=(const node_pool&));
+
+  /// Constructs a T from args in a node and returns the node as a value
+  /// that can be stored in a deque.
+  template<typename... Args>
+  size_t make(Args&&... args) {
+    size_t v;
+    node* n = _free.right_pop(&v) ? to_node(v) : new node;
+    try {
+      new (&n->_storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      recycle(n);
+      throw;
+    }
+    return reinterpret_cast<size_t>(n);
+  }
+
+  T& value(size_t v) { return *reinterpret_cast<T*>(&to_node(v)->_storage); }
+
+  /// Destroys the T held by node v and returns the node to the pool.
+  void release(size_t v) {
+    value(v).~T();
+    recycle(to_node(v));
+  }
+};
+
+/// Scalar values (integers, enums, pointers) that fit in a size_t are
+/// stored directly in the deque, as in deque_size_t, and need no node.
+/// Larger scalars, such as long double, use a node_pool.
+template<class T>
+class inline_values {
+  static_assert(sizeof(T) <= sizeof(size_t), "T must fit in a size_t");
+
+public:
+  explicit inline_values(size_t) {}
+
+  MARE_DELETE_METHOD(inline_values());
+  MARE_DELETE_METHOD(inline_values(const inline_values&));
+  MARE_DELETE_METHOD(inline_values& operator=(const inline_values&));
+
+  size_t make(T const& value) {
+    size_t v = 0;
+    memcpy(&v, &value, sizeof(T));
+    return v;
+  }
+
+  T value(size_t v) {
+    T value;
+    memcpy(&value, &v, sizeof(T));
+    return value;
+  }
+
+  void release(size_t) {}
+};
+
+template<class T, class PREDICTOR>
+struct value_storage {
+  typedef typename std::conditional<std::is_scalar<T>::value &&
+                                    sizeof(T) <= sizeof(size_t),
+                                    inline_values<T>,
+                                    node_pool<T, PREDICTOR> >::type type;
+};
+
+template<class PREDICTOR>
+struct segment {
+  explicit segment(size_t qsize) :
+    _deque(qsize),
+    _next(nullptr),
+    _pushers(0),
+    _poppers(0),
+    _closed(false) {}
+
+  MARE_DELETE_METHOD(segment());
+  MARE_DELETE_METHOD(segment(const segment&));
+  MARE_DELETE_METHOD(segment& operator=(const segment&));
+
+  deque<PREDICTOR> _deque;
+
+  // queue_segments: the segment that follows this one in FIFO order.
+  // stack_segments: the segment below this one.
+  std::atomic<segment*> _next;
+
+  // Number of threads currently operating on _deque (queue_segments only)
+  std::atomic<size_t> _pushers;
+  std::atomic<size_t> _poppers;
+
+  // Set once _next is linked; no push into _deque may start afterwards
+  // (queue_segments only)
+  std::atomic<bool> _closed;
+};
+
+// Segments do not grow beyond this size, unless the initial segment is
+// already larger.
+static const size_t max_segment_size = 1 << 16;
+
+static inline size_t
+next_segment_size(size_t qsize)
+{
+  return std::max(qsize, std::min(2 * qsize, max_segment_size));
+}
+
+/// FIFO list of segments. Values are pushed to the right of the tail
+/// segment and popped from the left of the head segment.
+///
+/// A pusher that finds the tail segment full links a new segment to it
+/// and closes it. Pushers announce themselves in _pushers before checking
+/// _closed, and only push into open segments. A popper that finds the
+/// head segment empty may only move _head to the next segment once the
+/// head segment is closed, no pusher is announced on it, and it is still
+/// empty; otherwise a value pushed late into the head segment would be
+/// lost.
+///
+/// Segments that _head moves past are retired, and reused for growing
+/// the queue later once no thread operates on them anymore. Segments are
+/// therefore never freed before the queue is destroyed, which makes it
+/// safe to announce oneself on a segment that was just retired: the
+/// announcement is only trusted if the segment is still _head (_tail)
+/// afterwards. The retired list is protected by _segments_lock, which is
+/// only taken when the queue grows or a segment is retired.
+template<class PREDICTOR>
+class queue_segments {
+private:
+  typedef segment<PREDICTOR> segment_type;
+
+  std::atomic<segment_type*> _head;
+  std::atomic<segment_type*> _tail;
+
+  std::mutex _segments_lock;
+  std::vector<segment_type*> _segments;
+  std::vector<segment_type*> _retired;
+
+  static segment_type* acquire(std::atomic<segment_type*>& end,
+                               std::atomic<size_t> segment_type::* users) {
+    for (;;) {
+      segment_type* s = end.load();
+      (s->*users).fetch_add(1);
+      if (end.load() == s)
+        return s;
+      (s->*users).fetch_sub(1);
+    }
+  }
+
+  segment_type* make_segment(size_t qsize) {
+    std::lock_guard<std::mutex> lock(_segments_lock);
+    for (auto it = _retired.begin(); it != _retired.end(); ++it) {
+      segment_type* s = *it;
+      if (s->_deque.size() >= qsize && s->_pushers.load() == 0 &&
+          s->_poppers.load() == 0) {
+        _retired.erase(it);
+        s->_next.store(nullptr);
+        s->_closed.store(false);
+        return s;
+      }
+    }
+    segment_type* s = new segment_type(next_segment_size(qsize));
+    _segments.push_back(s);
+    return s;
+  }
+
+  void retire(segment_type* s) {
+    std::lock_guard<std::mutex> lock(_segments_lock);
+    _retired.push_back(s);
+  }
+
+  // The caller must be announced in s->_pushers, so that s cannot be
+  // retired until grow() returns.
+  void grow(segment_type* s) {
+    segment_type* next = s->_next.load();
+    if (next == nullptr) {
+      segment_type* fresh = make_segment(s->_deque.size());
+      if (s->_next.compare_exchange_strong(next, fresh))
+        next = fresh;
+      else
+        retire(fresh);
+    }
+    s->_closed.store(true);
+    _tail.compare_exchange_strong(s, next);
+  }
+
+public:
+  explicit queue_segments(size_t qsize) :
+    _head(nullptr),
+    _tail(nullptr),
+    _segments_lock(),
+    _segments(),
+    _retired() {
+    segment_type* s = new segment_type(qsize);
+    _segments.push_back(s);
+    _head.store(s);
+    _tail.store(s);
+  }
+
+  ~queue_segments() {
+    for (auto s : _segments)
+      delete s;
+  }
+
+  MARE_DELETE_METHOD(queue_segments());
+  MARE_DELETE_METHOD(queue_segments(const queue_segments&));
+  MARE_DELETE_METHOD(queue_segments& operator=(const queue_segments&));
+
+  void push(size_t const* values, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+      segment_type* s = acquire(_tail, &segment_type::_pushers);
+      if (!s->_closed.load()) {
+        while (done < n && s->_deque.right_push(values[done]))
+          ++done;
+      }
+      if (done < n)
+        grow(s);
+      s->_pushers.fetch_sub(1);
+    }
+  }
+
+  size_t pop(size_t* values, size_t n) {
+    size_t done = 0;
+    for (;;) {
+      segment_type* s = acquire(_head, &segment_type::_poppers);
+      while (done < n && s->_deque.left_pop(&values[done]))
+        ++done;
+
+      segment_type* next = s->_next.load();
+      if (done == n || next == nullptr) {
+        s->_poppers.fetch_sub(1);
+        return done;
+      }
+
+      // s has been superseded by next; make sure no push into s is still
+      // pending before leaving it behind.
+      s->_closed.store(true);
+      bool advanced = false;
+      if (s->_pushers.load() == 0) {
+        if (s->_deque.left_pop(&values[done])) {
+          ++done;
+        } else {
+          segment_type* expected = s;
+          advanced = _head.compare_exchange_strong(expected, next);
+          if (advanced) {
+            // _tail must not point to a retired segment
+            expected = s;
+            _tail.compare_exchange_strong(expected, next);
+          }
+        }
+      }
+      s->_poppers.fetch_sub(1);
+      if (advanced)
+        retire(s);
+    }
+  }
+};
+
+/// LIFO list of segments. Values are pushed to and popped from the right
+/// of the top segment. A pusher that finds the top segment full puts
+/// another segment on top of it. A popper that finds the top segment
+/// empty drops it and continues with the segment below.
+///
+/// Dropping the top segment follows the protocol of queue_segments: the
+/// popper closes it, and only moves _top down if no pusher is announced
+/// on it and it is still empty. Pushers announce themselves in _pushers,
+/// check that the segment is still _top, and only push into open
+/// segments; a pusher that finds the top segment closed puts a segment
+/// on top of it instead.
+///
+/// Dropped segments are retired, and reused when the stack grows again,
+/// so a stack that is filled and emptied repeatedly keeps a bounded set
+/// of segments. As in queue_segments, segments are only freed when the
+/// stack is destroyed.
+template<class PREDICTOR>
+class stack_segments {
+private:
+  typedef segment<PREDICTOR> segment_type;
+
+  std::atomic<segment_type*> _top;
+
+  std::mutex _segments_lock;
+  std::vector<segment_type*> _segments;
+  std::vector<segment_type*> _retired;
+
+  segment_type* acquire(std::atomic<size_t> segment_type::* users) {
+    for (;;) {
+      segment_type* s = _top.load();
+      (s->*users).fetch_add(1);
+      if (_top.load() == s)
+        return s;
+      (s->*users).fetch_sub(1);
+    }
+  }
+
+  segment_type* make_segment(size_t qsize) {
+    std::lock_guard<std::mutex> lock(_segments_lock);
+    for (auto it = _retired.begin(); it != _retired.end(); ++it) {
+      segment_type* s = *it;
+      if (s->_deque.size() >= qsize && s->_pushers.load() == 0 &&
+          s->_poppers.load() == 0) {
+        _retired.erase(it);
+        s->_closed.store(false);
+        return s;
+      }
+    }
+    segment_type* s = new segment_type(next_segment_size(qsize));
+    _segments.push_back(s);
+    return s;
+  }
+
+  void retire(segment_type* s) {
+    std::lock_guard<std::mutex> lock(_segments_lock);
+    _retired.push_back(s);
+  }
+
+  void grow(segment_type* s) {
+    segment_type* fresh = make_segment(s->_deque.size());
+    fresh->_next.store(s);
+    if (!_top.compare_exchange_strong(s, fresh))
+      retire(fresh);
+  }
+
+  // Pops from the segments below s, which is the top segment but could
+  // not be dropped because a push into it is pending.
+  size_t pop_below(segment_type* s, size_t* values, size_t n) {
+    size_t done = 0;
+    for (s = s->_next.load(); s != nullptr && done < n; s = s->_next.load()) {
+      while (done < n && s->_deque.right_pop(&values[done]))
+        ++done;
+    }
+    return done;
+  }
+
+public:
+  explicit stack_segments(size_t qsize) :
+    _top(nullptr),
+    _segments_lock(),
+    _segments(),
+    _retired() {
+    segment_type* s = new segment_type(qsize);
+    _segments.push_back(s);
+    _top.store(s);
+  }
+
+  ~stack_segments() {
+    for (auto s : _segments)
+      delete s;
+  }
+
+  MARE_DELETE_METHOD(stack_segments());
+  MARE_DELETE_METHOD(stack_segments(const stack_segments&));
+  MARE_DELETE_METHOD(stack_segments& operator=(const stack_segments&));
+
+  void push(size_t const* values, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+      segment_type* s = acquire(&segment_type::_pushers);
+      if (!s->_closed.load()) {
+        while (done < n && s->_deque.right_push(values[done]))
+          ++done;
+      }
+      if (done < n)
+        grow(s);
+      s->_pushers.fetch_sub(1);
+    }
+  }
+
+  size_t pop(size_t* values, size_t n) {
+    size_t done = 0;
+    for (;;) {
+      segment_type* s = acquire(&segment_type::_poppers);
+      while (done < n && s->_deque.right_pop(&values[done]))
+        ++done;
+
+      segment_type* below = s->_next.load();
+      if (done == n || below == nullptr) {
+        s->_poppers.fetch_sub(1);
+        return done;
+      }
+
+      // s is empty; drop it unless a push into it is still pending.
+      s->_closed.store(true);
+      bool dropped = false;
+      if (s->_pushers.load() == 0) {
+        if (s->_deque.right_pop(&values[done])) {
+          ++done;
+        } else {
+          segment_type* expected = s;
+          dropped = _top.compare_exchange_strong(expected, below);
+        }
+      } else {
+        done += pop_below(s, values + done, n - done);
+        s->_poppers.fetch_sub(1);
+        return done;
+      }
+      s->_poppers.fetch_sub(1);
+      if (dropped)
+        retire(s);
+    }
+  }
+};
+
+/// Stores values of type T in a SEGMENTS list (queue_segments or
+/// stack_segments), using a node_pool for the nodes holding the values
+/// unless T is a scalar.
+template<class T, class PREDICTOR, class SEGMENTS>
+class unbounded {
+private:
+  // Number of nodes handled per call to SEGMENTS::push/pop by the batch
+  // operations
+  static const size_t batch_size = 64;
+
+  typename value_storage<T, PREDICTOR>::type _pool;
+  SEGMENTS _segments;
+
+public:
+  explicit unbounded(size_t qsize) :
+    _pool(qsize),
+    _segments(qsize) {}
+
+  ~unbounded() {
+    size_t v;
+    while (_segments.pop(&v, 1) != 0)
+      _pool.release(v);
+  }
+
+  MARE_DELETE_METHOD(unbounded());
+  MARE_DELETE_METHOD(unbounded(const unbounded&));
+  MARE_DELETE_METHOD(unbounded& operator=(const unbounded&));
+
+  template<typename... Args>
+  void emplace(Args&&... args) {
+    size_t v = _pool.make(std::forward<Args>(args)...);
+    try {
+      _segments.push(&v, 1);
+    } catch (...) {
+      _pool.release(v);
+      throw;
+    }
+  }
+
+  bool pop(T& result) {
+    size_t v;
+    if (_segments.pop(&v, 1) == 0)
+      return false;
+    result = std::move(_pool.value(v));
+    _pool.release(v);
+    return true;
+  }
+
+  template<class InputIt>
+  size_t push_n(InputIt first, size_t n) {
+    size_t values[batch_size];
+    for (size_t done = 0; done < n; ) {
+      size_t chunk = std::min(n - done, batch_size);
+      size_t made = 0;
+      try {
+        for (; made < chunk; ++made, ++first)
+          values[made] = _pool.make(*first);
+      } catch (...) {
+        _segments.push(values, made);
+        throw;
+      }
+      _segments.push(values, chunk);
+      done += chunk;
+    }
+    return n;
+  }
+
+  template<class OutputIt>
+  size_t pop_n(OutputIt result, size_t n) {
+    size_t values[batch_size];
+    size_t done = 0;
+    while (done < n) {
+      size_t chunk = std::min(n - done, batch_size);
+      size_t popped = _segments.pop(values, chunk);
+      for (size_t i = 0; i < popped; ++i, ++result) {
+        *result = std::move(_pool.value(values[i]));
+        _pool.release(values[i]);
+      }
+      done += popped;
+      if (popped < chunk)
+        break;
+    }
+    return done;
+  }
+};
+
+template<class T, class PREDICTOR, class SEGMENTS>
+const size_t unbounded<T, PREDICTOR, SEGMENTS>::batch_size;
+
+}; // namespace cof
+
+}; // namespace internal
+
+}; // namespace mare
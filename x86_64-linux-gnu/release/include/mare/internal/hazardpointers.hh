@@ -515,6 +515,22 @@ public:
     retireNode(_myhprec,node);
   }
 
+  ///
+  /// Deletes the retired nodes of all records, regardless of hazard
+  /// pointers. The records themselves are kept.
+  /// IMPORTANT: Only call this once no thread uses the datastructure
+  /// anymore, e.g., from the destructor of the datastructure.
+  ///
+  void reclaimAll() {
+    for(Record_p hprec = _headHPRecord; hprec; hprec = hprec->next()) {
+      while(hprec->rCount()>0) {
+        TN* node;
+        hprec->pop(node);
+        delete node;
+      }
+    }
+  }
+
   ///
   /// Access the specified slot of hazard pointers, read-only.
   /// @param slot The hazard pointer slot of the current thread. 0<=slot<K
@@ -0,0 +1,278 @@
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+// Copyright 2013 Qualcomm Technologies, Inc.  All rights reserved.
+// Confidential & Proprietary – Qualcomm Technologies, Inc. ("QTI")
+// 
+// The party receiving this software directly from QTI (the "Recipient")
+// may use this software as reasonably necessary solely for the purposes
+// set forth in the agreement between the Recipient and QTI (the
+// "Agreement").  The software may be used in source code form solely by
+// the Recipient's employees (if any) authorized by the Agreement.
+// Unless expressly authorized in the Agreement, the Recipient may not
+// sublicense, assign, transfer or otherwise provide the source code to
+// any third party.  Qualcomm Technologies, Inc. retains all ownership
+// rights in and to the software.
+// --~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~----~--~--~--~--
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <mare/internal/debug.hh>
+#include <mare/internal/macros.hh>
+#include <mare/internal/synchronization/mutex.hh>
+#include <mare/internal/task.hh>
+
+namespace mare {
+
+namespace internal {
+
+/// Lets tasks wait for a condition without blocking their thread.
+///
+/// A task first spins a few times, yielding to the MARE scheduler between
+/// attempts, as mare::mutex does. If the condition is still not met, it
+/// announces itself in _waiters and blocks on a futex. Whoever may have
+/// made the condition true calls notify(), which only touches the futex
+/// if a task has announced itself.
+///
+/// _epoch closes the race between a waiter that checks the condition and
+/// a notify() that happens right before the waiter blocks: the waiter
+/// only blocks if _epoch has not changed since before its last check.
+class mpmc_wait_list {
+private:
+  futex _futex;
+  std::atomic<int> _epoch;
+  std::atomic<size_t> _waiters;
+
+public:
+  static const int SPIN_THRESHOLD = 10;
+
+  mpmc_wait_list() : _futex(), _epoch(0), _waiters(0) {}
+
+  MARE_DELETE_METHOD(mpmc_wait_list(mpmc_wait_list&));
+  MARE_DELETE_METHOD(mpmc_wait_list(mpmc_wait_list&&));
+  MARE_DELETE_METHOD(mpmc_wait_list& operator=(mpmc_wait_list const&));
+  MARE_DELETE_METHOD(mpmc_wait_list& operator=(mpmc_wait_list&&));
+
+  /// Calls attempt() until it returns true.
+  template<typename Attempt>
+  void wait_until(Attempt&& attempt) {
+    for (int spins = 0; spins < SPIN_THRESHOLD; ++spins) {
+      if (attempt())
+        return;
+      yield();
+    }
+
+    for (;;) {
+      int epoch = _epoch.load();
+      _waiters.fetch_add(1);
+      if (attempt()) {
+        _waiters.fetch_sub(1);
+        return;
+      }
+      _futex.wait(&_epoch, epoch);
+      _waiters.fetch_sub(1);
+    }
+  }
+
+  /// Wakes up to num_tasks waiting tasks (0 wakes all of them).
+  void notify(size_t num_tasks) {
+    // Orders the caller's update of the condition before the load of
+    // _waiters; pairs with the fetch_add in wait_until().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0)
+      return;
+    _epoch.fetch_add(1);
+    _futex.wakeup(num_tasks);
+  }
+};
+
+/// Bounded multi-producer/multi-consumer ring buffer
+///
+/// Follows D. Vyukov's bounded MPMC queue: every slot carries a sequence
+/// number that tells producers and consumers which lap around the ring
+/// the slot is ready for:
+///
+///   slot._sequence == pos             slot is empty, producer of
+///                                     position pos may fill it
+///   slot._sequence == pos + 1         slot is full, consumer of
+///                                     position pos may empty it
+///
+/// A producer claims position pos by advancing _enqueue_pos with a CAS,
+/// constructs the value in the slot and then publishes it by storing
+/// pos + 1 into the sequence number. A consumer claims pos by advancing
+/// _dequeue_pos, moves the value out and releases the slot to the next
+/// lap by storing pos + capacity. Producers and consumers only contend on
+/// their own end of the ring, and never on the same slot at the same time.
+///
+/// try_push_n/try_pop_n claim a run of consecutive slots with a single
+/// CAS. A run is ready as soon as the sequence number of each of its
+/// slots says so, because the slot at pos + i cannot change state before
+/// _enqueue_pos (_dequeue_pos) has moved past pos + i.
+///
+/// A claimed slot must be published even if constructing its value
+/// throws, or the consumer of its position would wait for it forever.
+/// Such slots are published as holes, which consumers release to the
+/// next lap without popping anything.
+///
+/// The capacity is rounded up to a power of two, so positions can be
+/// mapped to slots with a mask.
+template<typename T>
+class mpmc_ring {
+private:
+  struct slot {
+    std::atomic<size_t> _sequence;
+    bool _hole;
+    typename std::aligned_storage<sizeof(T),
+                                  std::alignment_of<T>::value>::type _storage;
+
+    T* value() { return reinterpret_cast<T*>(&_storage); }
+  };
+
+  // Keeps the producer and consumer positions on separate cache lines
+  static const size_t cache_line_size = 64;
+
+  slot* const _slots;
+  size_t const _mask;
+
+  char _pad0[cache_line_size];
+  std::atomic<size_t> _enqueue_pos;
+  char _pad1[cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> _dequeue_pos;
+  char _pad2[cache_line_size - sizeof(std::atomic<size_t>)];
+
+  static size_t round_up_capacity(size_t capacity) {
+    MARE_API_ASSERT(capacity > 0, "mpmc_queue capacity must be > 0");
+    size_t c = 1;
+    while (c < capacity)
+      c <<= 1;
+    return c;
+  }
+
+  // Claims up to n consecutive slots starting at pos, whose sequence
+  // numbers are pos + i + offset. Returns the number of slots claimed,
+  // and sets pos to the first of them.
+  size_t claim(std::atomic<size_t>& end, size_t offset, size_t n,
+               size_t& pos) {
+    pos = end.load(std::memory_order_relaxed);
+    if (n == 0)
+      return 0;
+    for (;;) {
+      size_t ready = 0;
+      while (ready < n) {
+        size_t seq = _slots[(pos + ready) & _mask]._sequence.load(
+                       std::memory_order_acquire);
+        if (seq != pos + ready + offset)
+          break;
+        ++ready;
+      }
+
+      if (ready == 0) {
+        // Either the ring is full (empty), or another producer (consumer)
+        // claimed pos already.
+        size_t seq = _slots[pos & _mask]._sequence.load(
+                       std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(seq - (pos + offset)) < 0)
+          return 0;
+        pos = end.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      if (end.compare_exchange_weak(pos, pos + ready,
+                                    std::memory_order_relaxed))
+        return ready;
+    }
+  }
+
+public:
+  explicit mpmc_ring(size_t capacity) :
+    _slots(new slot[round_up_capacity(capacity)]),
+    _mask(round_up_capacity(capacity) - 1),
+    _pad0(),
+    _enqueue_pos(0),
+    _pad1(),
+    _dequeue_pos(0),
+    _pad2() {
+    for (size_t i = 0; i <= _mask; ++i) {
+      _slots[i]._sequence.store(i, std::memory_order_relaxed);
+      _slots[i]._hole = false;
+    }
+  }
+
+  ~mpmc_ring() {
+    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    size_t end = _enqueue_pos.load(std::memory_order_relaxed);
+    for (; pos != end; ++pos) {
+      slot& s = _slots[pos & _mask];
+      if (!s._hole)
+        s.value()->~T();
+    }
+    delete[] _slots;
+  }
+
+  MARE_DELETE_METHOD(mpmc_ring());
+  MARE_DELETE_METHOD(mpmc_ring(mpmc_ring const&));
+  MARE_DELETE_METHOD(mpmc_ring& operator=(mpmc_ring const&));
+
+  size_t capacity() const { return _mask + 1; }
+
+  /// Number of elements in the ring; only a snapshot if the ring is
+  /// being used concurrently.
+  size_t size() const {
+    size_t deq = _dequeue_pos.load(std::memory_order_relaxed);
+    size_t enq = _enqueue_pos.load(std::memory_order_relaxed);
+    return enq > deq ? enq - deq : 0;
+  }
+
+  template<typename InputIt>
+  size_t try_push_n(InputIt first, size_t n) {
+    size_t pos;
+    size_t claimed = claim(_enqueue_pos, 0, n, pos);
+    size_t i = 0;
+    try {
+      for (; i < claimed; ++i, ++first) {
+        slot& s = _slots[(pos + i) & _mask];
+        new (s.value()) T(*first);
+        s._sequence.store(pos + i + 1, std::memory_order_release);
+      }
+    } catch (...) {
+      for (; i < claimed; ++i) {
+        slot& s = _slots[(pos + i) & _mask];
+        s._hole = true;
+        s._sequence.store(pos + i + 1, std::memory_order_release);
+      }
+      throw;
+    }
+    return claimed;
+  }
+
+  template<typename OutputIt>
+  size_t try_pop_n(OutputIt result, size_t n) {
+    size_t popped = 0;
+    while (popped < n) {
+      size_t pos;
+      size_t claimed = claim(_dequeue_pos, 1, n - popped, pos);
+      if (claimed == 0)
+        break;
+      for (size_t i = 0; i < claimed; ++i) {
+        slot& s = _slots[(pos + i) & _mask];
+        if (s._hole) {
+          s._hole = false;
+        } else {
+          *result = std::move(*s.value());
+          s.value()->~T();
+          ++result;
+          ++popped;
+        }
+        s._sequence.store(pos + i + _mask + 1, std::memory_order_release);
+      }
+    }
+    return popped;
+  }
+};
+
+} //namespace internal
+
+} //namespace mare
@@ -67,7 +67,7 @@ bool write(channel * c, char const* buffer, bool spin_on_blocked_channel);
 template<typename T>
 bool pop_value(data_channel<T>& dc, T& t)
 {
-  channel* c = dynamic_cast<channel*>(&dc);
+  channel* c = static_cast<channel*>(&dc);
   return read(c, reinterpret_cast<char*>(&t), false);
     //returns true if read successfully, false if must be re-tried
 }
@@ -83,7 +83,7 @@ bool pop_buf(channel* c, void* buf)
 template<typename T>
 bool push_value(data_channel<T>& dc, T const& t)
 {
-  channel* c = dynamic_cast<channel*>(&dc);
+  channel* c = static_cast<channel*>(&dc);
   return write(c, reinterpret_cast<char const*>(&t), false);
     //returns true if written successfully, false if must be re-tried
 }
@@ -109,7 +109,7 @@ map_data_channel_ref_to_channel_ptr_helper(
   data_channel<T>& dc,
   data_channel<Ts>&... rest_dcs)
 {
-  vchannels.push_back( dynamic_cast<channel*>(&dc) );
+  vchannels.push_back( static_cast<channel*>(&dc) );
 
   map_data_channel_ref_to_channel_ptr_helper(vchannels, rest_dcs...);
 }
@@ -154,7 +154,7 @@ map_data_channel_tuple_to_channel_ptr_helper(
   std::tuple< data_channel<Ts>*... >& pdc_tuple)
 {
   vchannels.push_back(
-                dynamic_cast<channel*>(
+                static_cast<channel*>(
                   std::get<sizeof...(Ts) - remaining>(pdc_tuple) ) );
 
   map_data_channel_tuple_to_channel_ptr_helper<remaining-1, Ts...>
@@ -257,7 +257,7 @@ std::vector<std::size_t> map_var_tuple_to_Tsize(
 template<typename T, typename Trange>
 void preload_channel(data_channel<T>&dc, Trange const& tr)
 {
-  channel* c = dynamic_cast<channel*>(&dc);
+  channel* c = static_cast<channel*>(&dc);
   internal::preload_allocate(c, tr.size());
 
   for(std::size_t i=0; i<tr.size(); i++) {
@@ -19,6 +19,7 @@
 #include <mare/internal/random.hh>
 #include <mare/internal/runtime.hh>
 #include <mare/internal/debug.hh>
+#include <mare/internal/log/log.hh>
 
 
 namespace mare {
@@ -43,10 +44,14 @@ extern std::atomic<int> MARE_SYMBOL_PROTECTION(init_count);
     thread pools. There should only be one call to init in the entire
     program, and it should be called before launching tasks or waiting
     for tasks or groups.
+
+    Also configures logging from the MARE_LOGGERS and MARE_LOG_EVENTS
+    environment variables, see mare/logging.hh.
 */
 inline void init()
 {
   mare::runtime::MARE_SYMBOL_PROTECTION(init_count).fetch_add(1);
+  mare::internal::log::init_from_environment();
   init_implementation();
 }
 
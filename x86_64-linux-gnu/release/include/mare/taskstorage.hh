@@ -18,6 +18,7 @@
 #include <mare/common.hh>
 #include <mare/exceptions.hh>
 
+#include <mare/internal/task.hh>
 #include <mare/internal/taskstorage.hh>
 
 namespace mare {
@@ -75,7 +76,10 @@ public:
 
   /** @returns Pointer to stored pointer value. */
   T* get() const {
-    return static_cast<T*>(task_get_specific(_key));
+    // Same as task_get_specific, but inlined into the caller
+    if (auto t = internal::current_task())
+      return static_cast<T*>(t->taskls().get_specific(_key));
+    return nullptr;
   }
 
   /** @returns Pointer to stored pointer value. */